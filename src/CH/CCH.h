@@ -0,0 +1,318 @@
+/* -*- mode: C++; indent-tabs-mode: nil; -*-
+ *
+ * This file is a part of LEMON, a generic C++ optimization library.
+ *
+ * Copyright (C) 2003-2013
+ * Egervary Jeno Kombinatorikus Optimalizalasi Kutatocsoport
+ * (Egervary Research Group on Combinatorial Optimization, EGRES).
+ *
+ * Permission to use, modify and distribute this software is granted
+ * provided that this copyright notice appears in all copies. For
+ * precise terms see the accompanying LICENSE file.
+ *
+ * This software is provided "AS IS" with no warranty of any kind,
+ * express or implied, and with no claim as to its suitability for any
+ * purpose.
+ *
+ */
+#ifndef CCH_H
+#define CCH_H
+
+#include <vector>
+#include <algorithm>
+#include <climits>
+#include <lemon/list_graph.h>
+#include <lemon/bin_heap.h>
+#include <lemon/maps.h>
+#include "Utils/QueryGraph.h"
+
+using std::vector;
+using std::sort;
+using std::unique;
+using std::max;
+using std::lower_bound;
+using std::set_union;
+using std::back_inserter;
+using lemon::BinHeap;
+using lemon::RangeMap;
+using lemon::ListDigraph;
+using lemon::INVALID;
+
+///Customizable contraction hierarchy.
+///
+///The contraction for a given order is metric-independent: every node connects all of its higher
+///neighbours, so no witness searches are needed and the arcs don't depend on the costs. The
+///customization calculates the weights of the arcs for a cost map by the lower triangles: the
+///weight of an arc u - w is improved through every lower node x adjacent to both. It can be
+///repeated for new costs, the queries run on the QueryGraph created after it.
+///
+///The nodes are stored by their rank in the order, arc a of node x goes to the higher node head[a],
+///the arcs of a node are sorted by the rank of their head.
+class CCH {
+
+  typedef ListDigraph Graph;
+  typedef Graph::Node Node;
+  typedef Graph::Arc Arc;
+  typedef Graph::ArcMap<int> Cost;
+
+private:
+
+  const Graph *_graph;
+  int _nodes;
+  ///The rank of every node id of the graph, -1 for unused ids
+  vector<int> _rank;
+  ///The first arc of every node
+  vector<int> _first;
+  vector<int> _head;
+  ///The first lower neighbour of every node
+  vector<int> _down_first;
+  ///The lower neighbours and the index of their arc to the node
+  vector<int> _down_node;
+  vector<int> _down_arc;
+  ///The nodes grouped by level, a node is above its lower neighbours
+  vector<int> _level_nodes;
+  vector<int> _level_first;
+  ///The arc and the direction of every original arc id, arc + 1 from the lower end, -arc - 1
+  ///to the lower end, 0 for loops and unused ids
+  vector<int> _arc_ref;
+
+  ///The weight of the arcs from the lower end and to the lower end
+  vector<int> _forward;
+  vector<int> _backward;
+  ///The unpack data of the arcs, the original arc id or -1 - the id of the bypassed node
+  ///in the query graph
+  vector<int> _forward_unpack;
+  vector<int> _backward_unpack;
+
+  ///\return The id of a node in the query graph, the highest node is 0
+  int queryId(int rank) const {
+    return _nodes - 1 - rank;
+  }
+
+  ///Calculates the weights of the arcs of a node from the final arcs of its lower neighbours.
+  ///\param u The rank of the node
+  void customizeNode(int u) {
+    for (int d = _down_first[u]; d < _down_first[u + 1]; ++d) {
+      int x = _down_node[d];
+      int xu = _down_arc[d];
+      if (_forward[xu] == INT_MAX && _backward[xu] == INT_MAX) continue;
+      // the arcs of x and u are sorted by head, the arcs of x after u go to higher neighbours of u
+      int uw = _first[u];
+      for (int xw = xu + 1; xw < _first[x + 1]; ++xw) {
+        while (_head[uw] != _head[xw]) ++uw;
+        if (_backward[xu] != INT_MAX && _forward[xw] != INT_MAX &&
+            _backward[xu] + _forward[xw] < _forward[uw]) {
+          _forward[uw] = _backward[xu] + _forward[xw];
+          _forward_unpack[uw] = -1 - queryId(x);
+        }
+        if (_backward[xw] != INT_MAX && _forward[xu] != INT_MAX &&
+            _backward[xw] + _forward[xu] < _backward[uw]) {
+          _backward[uw] = _backward[xw] + _forward[xu];
+          _backward_unpack[uw] = -1 - queryId(x);
+        }
+      }
+    }
+  }
+
+public:
+
+  ///Runs the metric-independent contraction.
+  ///\param graph The graph, it is not changed and it has to exist while the CCH is customized
+  ///\param order The node ids of the graph in the order of contraction, e.g. CHInterface::getOrder()
+  CCH(const ListDigraph& graph, const vector<int>& order):
+    _graph(&graph), _nodes(order.size()) {
+    _rank.assign(graph.maxNodeId() + 1, -1);
+    for (int i = 0; i < _nodes; ++i) {
+      _rank[order[i]] = i;
+    }
+
+    // the higher neighbours, extended by the neighbours of the contracted lower nodes
+    vector<vector<int> > up(_nodes);
+    for (Graph::ArcIt e(graph); e != INVALID; ++e) {
+      int u = _rank[graph.id(graph.source(e))];
+      int w = _rank[graph.id(graph.target(e))];
+      if (u < w) up[u].push_back(w);
+      else if (w < u) up[w].push_back(u);
+    }
+    for (int u = 0; u < _nodes; ++u) {
+      sort(up[u].begin(), up[u].end());
+      up[u].erase(unique(up[u].begin(), up[u].end()), up[u].end());
+      // the lowest higher neighbour is contracted next among them, it gets the others as neighbours
+      if (up[u].size() > 1) up[up[u][0]].insert(up[up[u][0]].end(), up[u].begin() + 1, up[u].end());
+    }
+
+    _first.assign(1, 0);
+    for (int u = 0; u < _nodes; ++u) {
+      _head.insert(_head.end(), up[u].begin(), up[u].end());
+      _first.push_back(_head.size());
+      vector<int>().swap(up[u]);
+    }
+
+    _down_first.assign(_nodes + 1, 0);
+    for (unsigned int a = 0; a < _head.size(); ++a) {
+      ++_down_first[_head[a] + 1];
+    }
+    for (int u = 0; u < _nodes; ++u) {
+      _down_first[u + 1] += _down_first[u];
+    }
+    _down_node.resize(_head.size());
+    _down_arc.resize(_head.size());
+    vector<int> pos(_down_first.begin(), _down_first.end() - 1);
+    vector<int> level(_nodes, 0);
+    int levels = _nodes > 0 ? 1 : 0;
+    for (int x = 0; x < _nodes; ++x) {
+      for (int a = _first[x]; a < _first[x + 1]; ++a) {
+        int u = _head[a];
+        _down_node[pos[u]] = x;
+        _down_arc[pos[u]] = a;
+        ++pos[u];
+        level[u] = max(level[u], level[x] + 1);
+        levels = max(levels, level[u] + 1);
+      }
+    }
+    _level_first.assign(levels + 1, 0);
+    for (int u = 0; u < _nodes; ++u) {
+      ++_level_first[level[u] + 1];
+    }
+    for (int l = 0; l < levels; ++l) {
+      _level_first[l + 1] += _level_first[l];
+    }
+    _level_nodes.resize(_nodes);
+    pos.assign(_level_first.begin(), _level_first.end() - 1);
+    for (int u = 0; u < _nodes; ++u) {
+      _level_nodes[pos[level[u]]++] = u;
+    }
+
+    _arc_ref.assign(graph.maxArcId() + 1, 0);
+    for (Graph::ArcIt e(graph); e != INVALID; ++e) {
+      int u = _rank[graph.id(graph.source(e))];
+      int w = _rank[graph.id(graph.target(e))];
+      if (u == w) continue;
+      int x = u < w ? u : w;
+      int a = lower_bound(_head.begin() + _first[x], _head.begin() + _first[x + 1], u < w ? w : u) - _head.begin();
+      _arc_ref[graph.id(e)] = u < w ? a + 1 : -a - 1;
+    }
+  }
+
+  ///Calculates the weights of the arcs for a cost function.
+  ///\param cost The cost of the arcs of the graph
+  ///\param parallel Whether the nodes of a level are customized in parallel
+  void customize(const Cost& cost, bool parallel = false) {
+    int arcs = _head.size();
+    _forward.assign(arcs, INT_MAX);
+    _backward.assign(arcs, INT_MAX);
+    _forward_unpack.assign(arcs, 0);
+    _backward_unpack.assign(arcs, 0);
+    for (Graph::ArcIt e(*_graph); e != INVALID; ++e) {
+      int r = _arc_ref[_graph->id(e)];
+      if (r > 0 && cost[e] < _forward[r - 1]) {
+        _forward[r - 1] = cost[e];
+        _forward_unpack[r - 1] = _graph->id(e);
+      }
+      if (r < 0 && cost[e] < _backward[-r - 1]) {
+        _backward[-r - 1] = cost[e];
+        _backward_unpack[-r - 1] = _graph->id(e);
+      }
+    }
+    if (!parallel) {
+      for (int u = 0; u < _nodes; ++u) {
+        customizeNode(u);
+      }
+      return;
+    }
+    // a node only writes its own arcs, and reads the arcs of the lower levels
+    for (unsigned int l = 0; l + 1 < _level_first.size(); ++l) {
+#pragma omp parallel for schedule(dynamic, 64) if (_level_first[l + 1] - _level_first[l] > 1000)
+      for (int i = _level_first[l]; i < _level_first[l + 1]; ++i) {
+        customizeNode(_level_nodes[i]);
+      }
+    }
+  }
+
+  ///Calculates a metric-independent order by eliminating a node of minimum degree in every step.
+  ///The orders of the witness search based contraction connect too many nodes. A nested dissection
+  ///order is better for large graphs, but this one is fine for the smaller ones.
+  ///\param graph The graph
+  ///\return The node ids in the order of contraction
+  static vector<int> minimumDegreeOrder(const ListDigraph& graph) {
+    int n = graph.maxNodeId() + 1;
+    vector<vector<int> > adjacent(n);
+    for (Graph::ArcIt e(graph); e != INVALID; ++e) {
+      int u = graph.id(graph.source(e));
+      int w = graph.id(graph.target(e));
+      if (u == w) continue;
+      adjacent[u].push_back(w);
+      adjacent[w].push_back(u);
+    }
+    RangeMap<int> state(n, -1);
+    BinHeap<int, RangeMap<int> > heap(state);
+    for (Graph::NodeIt v(graph); v != INVALID; ++v) {
+      vector<int>& a = adjacent[graph.id(v)];
+      sort(a.begin(), a.end());
+      a.erase(unique(a.begin(), a.end()), a.end());
+      heap.push(graph.id(v), a.size());
+    }
+    vector<int> order;
+    vector<int> merged;
+    while (!heap.empty()) {
+      int v = heap.top();
+      heap.pop();
+      order.push_back(v);
+      // the remaining neighbours of v become a clique
+      const vector<int>& a = adjacent[v];
+      for (unsigned int i = 0; i < a.size(); ++i) {
+        int u = a[i];
+        merged.clear();
+        set_union(adjacent[u].begin(), adjacent[u].end(), a.begin(), a.end(), back_inserter(merged));
+        adjacent[u].clear();
+        for (unsigned int j = 0; j < merged.size(); ++j) {
+          if (merged[j] != u && merged[j] != v) adjacent[u].push_back(merged[j]);
+        }
+        heap.set(u, adjacent[u].size());
+      }
+      vector<int>().swap(adjacent[v]);
+    }
+    return order;
+  }
+
+  ///\return The number of nodes
+  int nodeNum() const {
+    return _nodes;
+  }
+
+  ///\return The number of arcs, including the shortcuts
+  int arcNum() const {
+    return _head.size();
+  }
+
+  ///Creates a query graph with the current weights, it has to be customized.
+  ///The caller has to delete it, it can be used after the CCH is customized again or deleted.
+  ///\return The query graph
+  QueryGraph* createQueryGraph() const {
+    vector<int> first(_nodes + 1, 0);
+    vector<int> head(_head.size());
+    vector<int> forward(_head.size());
+    vector<int> backward(_head.size());
+    vector<int> forward_unpack(_head.size());
+    vector<int> backward_unpack(_head.size());
+    // the query graph numbers the nodes in descending rank
+    for (int id = 0; id < _nodes; ++id) {
+      int u = _nodes - 1 - id;
+      first[id + 1] = first[id] + _first[u + 1] - _first[u];
+      for (int a = _first[u], b = first[id]; a < _first[u + 1]; ++a, ++b) {
+        head[b] = queryId(_head[a]);
+        forward[b] = _forward[a];
+        backward[b] = _backward[a];
+        forward_unpack[b] = _forward_unpack[a];
+        backward_unpack[b] = _backward_unpack[a];
+      }
+    }
+    vector<int> node_ref(_rank.size(), -1);
+    for (unsigned int v = 0; v < _rank.size(); ++v) {
+      if (_rank[v] != -1) node_ref[v] = queryId(_rank[v]);
+    }
+    return new QueryGraph(first, head, forward, backward, forward_unpack, backward_unpack, node_ref);
+  }
+};
+
+#endif
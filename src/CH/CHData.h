@@ -28,41 +28,60 @@ using lemon::StaticDigraph;
 using std::pair;
 using std::vector;
 
+///The arcs bypassed by a shortcut, given by their arc codes.
+struct PackedArc {
+  int first;
+  int second;
+  ///The id of the bypassed node in the original graph
+  int middle;
+
+  PackedArc(int f, int s, int m): first(f), second(s), middle(m) {}
+};
+
 ///A struct containing every object that is required for CH searches.
+///
+///The arcs of the search graphs are given by arc codes: the id of an arc of the original graph,
+///or -1 - i for the i-th shortcut in pack. The shortcuts are not kept in the original graph.
 struct CHData {
 
   ///The original graph
   ListDigraph *graph;
   ///The original cost function on arcs
   ListDigraph::ArcMap<int> *cost;
-  ///The pair of arcs that are bypassed by a new arc
-  ListDigraph::ArcMap<pair<ListDigraph::Arc,ListDigraph::Arc> > *pack;
+  ///The pair of arcs bypassed by every shortcut
+  vector<PackedArc> *pack;
+  ///The number of original arcs represented by an arc, only set during the preprocessing
+  ListDigraph::ArcMap<int> *hops;
   ///The number of nodes
   int nodes;
   ///Vector containing the node ids in the order of contraction
   vector<int> *order;
   ///True if the order vector is not used outside the package
   bool local_order;
+  ///True if the graph and the cost are a copy owned by the package
+  bool local_graph;
   ///The forward search graph
   StaticDigraph *forward_graph;
   ///The cost of the arcs in the forward search graph
   StaticDigraph::ArcMap<int> *forward_cost;
   ///Node reference from the original graph to the forward search graph
   ListDigraph::NodeMap<StaticDigraph::Node> *forward_nodeRef;
-  ///Node reference from the forward search graph to the original graph
-  StaticDigraph::ArcMap<ListDigraph::Arc> *forward_backArcRef;
+  ///The arc code of the arcs in the forward search graph
+  StaticDigraph::ArcMap<int> *forward_backArcRef;
   ///The backward search graph
   StaticDigraph *backward_graph;
   ///The cost of the arcs in the backward search graph
   StaticDigraph::ArcMap<int> *backward_cost;
   ///Node reference from the original graph to the backward search graph
   ListDigraph::NodeMap<StaticDigraph::Node> *backward_nodeRef;
-  ///Node reference from the backward search graph to the original graph
-  StaticDigraph::ArcMap<ListDigraph::Arc> *backward_backArcRef;
+  ///The arc code of the arcs in the backward search graph
+  StaticDigraph::ArcMap<int> *backward_backArcRef;
 
   CHData(ListDigraph& g, ListDigraph::ArcMap<int>& c):
     graph(&g), cost(&c) {
     local_order = true;
+    local_graph = false;
+    hops = NULL;
   }
 
   ~CHData() {
@@ -78,6 +97,56 @@ struct CHData {
     if (local_order) {
       delete order;
     }
+    if (local_graph) {
+      delete cost;
+      delete graph;
+    }
+  }
+
+  ///Replaces the graph and the cost with a copy, so the preprocessing doesn't change them.
+  ///The nodes and arcs of the copy have the ids of the original ones.
+  void copyGraph() {
+    ListDigraph *g = new ListDigraph();
+    ListDigraph::ArcMap<int> *c = new ListDigraph::ArcMap<int>(*g);
+    g->reserveNode(graph->maxNodeId() + 1);
+    g->reserveArc(graph->maxArcId() + 1);
+    for (int i = 0; i <= graph->maxNodeId(); ++i) {
+      g->addNode();
+    }
+    // the unused ids get placeholder arcs, so the following arcs keep their ids
+    vector<ListDigraph::Arc> unused;
+    for (int i = 0; i <= graph->maxArcId(); ++i) {
+      ListDigraph::Arc e = ListDigraph::arcFromId(i);
+      if (graph->valid(e)) {
+        ListDigraph::Arc f = g->addArc(g->nodeFromId(graph->id(graph->source(e))),
+          g->nodeFromId(graph->id(graph->target(e))));
+        (*c)[f] = (*cost)[e];
+      } else {
+        unused.push_back(g->addArc(g->nodeFromId(0), g->nodeFromId(0)));
+      }
+    }
+    for (unsigned int i = 0; i < unused.size(); ++i) {
+      g->erase(unused[i]);
+    }
+    for (int i = 0; i <= graph->maxNodeId(); ++i) {
+      if (!graph->valid(ListDigraph::nodeFromId(i))) g->erase(g->nodeFromId(i));
+    }
+    graph = g;
+    cost = c;
+    local_graph = true;
+  }
+
+  ///Recursively unpacks an arc of the search graphs.
+  ///\param path The original arcs are appended to it
+  ///\param code The arc code of the arc
+  void unpack(vector<ListDigraph::Arc>& path, int code) const {
+    if (code >= 0) {
+      path.push_back(ListDigraph::arcFromId(code));
+    } else {
+      const PackedArc& p = (*pack)[-1 - code];
+      unpack(path, p.first);
+      unpack(path, p.second);
+    }
   }
 
   void setOrder(vector<int>& ordervector) {
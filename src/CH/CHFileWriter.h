@@ -0,0 +1,118 @@
+/* -*- mode: C++; indent-tabs-mode: nil; -*-
+ *
+ * This file is a part of LEMON, a generic C++ optimization library.
+ *
+ * Copyright (C) 2003-2013
+ * Egervary Jeno Kombinatorikus Optimalizalasi Kutatocsoport
+ * (Egervary Research Group on Combinatorial Optimization, EGRES).
+ *
+ * Permission to use, modify and distribute this software is granted
+ * provided that this copyright notice appears in all copies. For
+ * precise terms see the accompanying LICENSE file.
+ *
+ * This software is provided "AS IS" with no warranty of any kind,
+ * express or implied, and with no claim as to its suitability for any
+ * purpose.
+ *
+ */
+#ifndef CHFILEWRITER_H
+#define CHFILEWRITER_H
+
+#include <cstdio>
+#include <vector>
+#include <lemon/list_graph.h>
+#include <lemon/static_graph.h>
+#include <lemon/error.h>
+#include "CHData.h"
+#include "Utils/CHFileFormat.h"
+
+using std::vector;
+using lemon::ListDigraph;
+using lemon::StaticDigraph;
+using lemon::INVALID;
+
+///Writes a preprocessed graph into a binary CH file, which can be queried by MappedCH.
+class CHFileWriter {
+
+  typedef StaticDigraph Graph;
+
+private:
+
+  const CHData *_data;
+  CHFileHeader _header;
+  vector<int> _section[CHFileHeader::SECTIONS];
+
+  ///Stores the arcs of a search graph as arrays.
+  void searchGraph(const Graph& graph, const Graph::ArcMap<int>& cost, const Graph::ArcMap<int>& code,
+    int begin) {
+    vector<int>& first = _section[begin];
+    vector<int>& head = _section[begin + 1];
+    vector<int>& arccost = _section[begin + 2];
+    vector<int>& arc = _section[begin + 3];
+    for (int i = 0; i < graph.nodeNum(); ++i) {
+      first.push_back(head.size());
+      for (Graph::OutArcIt e(graph, graph.nodeFromId(i)); e != INVALID; ++e) {
+        head.push_back(Graph::id(graph.target(e)));
+        arccost.push_back(cost[e]);
+        arc.push_back(code[e]);
+      }
+    }
+    first.push_back(head.size());
+  }
+
+public:
+
+  ///Collects the arrays of the file.
+  ///\param chdata The CHData containing a preprocessed graph
+  CHFileWriter(const CHData& chdata):
+    _data(&chdata) {
+    const ListDigraph& g = *_data->graph;
+    _header.nodes = _data->forward_graph->nodeNum();
+    _header.max_node_id = g.maxNodeId();
+    _header.forward_arcs = _data->forward_graph->arcNum();
+    _header.backward_arcs = _data->backward_graph->arcNum();
+    _header.shortcuts = _data->pack->size();
+    _header.layout();
+
+    _section[CHFileHeader::NODE_REF].assign(g.maxNodeId() + 1, -1);
+    _section[CHFileHeader::NODE_ID].resize(_header.nodes);
+    for (ListDigraph::NodeIt v(g); v != INVALID; ++v) {
+      int i = Graph::id((*_data->forward_nodeRef)[v]);
+      _section[CHFileHeader::NODE_REF][ListDigraph::id(v)] = i;
+      _section[CHFileHeader::NODE_ID][i] = ListDigraph::id(v);
+    }
+    _section[CHFileHeader::ORDER] = *_data->order;
+    searchGraph(*_data->forward_graph, *_data->forward_cost, *_data->forward_backArcRef,
+      CHFileHeader::FORWARD_BEGIN);
+    searchGraph(*_data->backward_graph, *_data->backward_cost, *_data->backward_backArcRef,
+      CHFileHeader::BACKWARD_BEGIN);
+
+    _section[CHFileHeader::PACK_FIRST].resize(_header.shortcuts);
+    _section[CHFileHeader::PACK_SECOND].resize(_header.shortcuts);
+    for (int i = 0; i < _header.shortcuts; ++i) {
+      _section[CHFileHeader::PACK_FIRST][i] = (*_data->pack)[i].first;
+      _section[CHFileHeader::PACK_SECOND][i] = (*_data->pack)[i].second;
+    }
+  }
+
+  ///Writes the file.
+  ///\param filename The name of the file
+  void write(const char* filename) const {
+    FILE *f = fopen(filename, "wb");
+    if (f == NULL) throw lemon::IoError("Cannot open file", filename);
+    bool ok = fwrite(&_header, sizeof(CHFileHeader), 1, f) == 1;
+    for (int i = 0; i < CHFileHeader::SECTIONS && ok; ++i) {
+      ok = fseek(f, _header.offset[i], SEEK_SET) == 0;
+      const vector<int>& s = _section[i];
+      if (ok && !s.empty()) ok = fwrite(&s[0], sizeof(int), s.size(), f) == s.size();
+    }
+    // pad the last array
+    if (ok && ftell(f) < _header.size) {
+      ok = fseek(f, _header.size - 1, SEEK_SET) == 0 && fputc(0, f) != EOF;
+    }
+    if (fclose(f) != 0) ok = false;
+    if (!ok) throw lemon::IoError("Cannot write file", filename);
+  }
+};
+
+#endif
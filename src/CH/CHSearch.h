@@ -21,14 +21,20 @@
 
 #include <lemon/static_graph.h>
 #include <vector>
+#include <lemon/list_graph.h>
 #include "Utils/SearchDijkstra.h"
+#include "Utils/QueryGraphDijkstra.h"
+#include "Utils/HeapPolicy.h"
 
 using std::cout;
 using std::min;
 using std::vector;
 using lemon::StaticDigraph;
+using lemon::ListDigraph;
 
 ///The class responsible for searching in the preprocessed graphs.
+///\tparam HP The heap policy of the searches
+template <typename HP = BinHeapPolicy>
 class CHSearch {
 
   typedef StaticDigraph Graph;
@@ -36,12 +42,19 @@ class CHSearch {
   typedef Graph::Arc Arc;
   typedef Graph::ArcMap<int> Cost;
   typedef Graph::OutArcIt OutArcIt;
-  typedef SearchDijkstra Dijkstra;
+  typedef SearchDijkstra<typename SearchHeap<Graph, HP>::type> Dijkstra;
+  typedef QueryGraphDijkstra<HP> QueryDijkstra;
 
 private:
 
   Dijkstra *_forward_dijkstra;
   Dijkstra *_backward_dijkstra;
+  ///The merged search graph, NULL if the searches run on the static graphs
+  const QueryGraph *_query_graph;
+  QueryDijkstra *_forward_query;
+  QueryDijkstra *_backward_query;
+  StaticDigraph::ArcMap<int> *_forward_back_arc_ref;
+  StaticDigraph::ArcMap<int> *_backward_back_arc_ref;
   Graph *_forward_graph;
   Graph *_backward_graph;
   Cost *_forward_cost;
@@ -61,25 +74,32 @@ private:
 
   ///Runs the search between the previously given source and target.
   void runSearch() {
+    if (_query_graph != NULL) runSearch(*_forward_query, *_backward_query);
+    else runSearch(*_forward_dijkstra, *_backward_dijkstra);
+  }
+
+  ///Runs the search between the previously given source and target.
+  template <typename D>
+  void runSearch(D& forward, D& backward) {
     Node v;
     // while no node was found which was finalized in both directions
     while (_dmin == -1) {
-      if (_forward_dijkstra->nextNode() != INVALID) {
-        v = _forward_dijkstra->processNextNode();
-        _dist_s = _forward_dijkstra->currentDist(v);
-        check(v);
+      if (forward.nextNode() != INVALID) {
+        v = forward.processNextNode();
+        _dist_s = forward.currentDist(v);
+        check(forward, backward, v);
       }
       else {
-        runBackward();
+        runBackward(forward, backward);
         return;
       }
-      if (_backward_dijkstra->nextNode() != INVALID) {
-        v = _backward_dijkstra->processNextNode();
-        _dist_t = _backward_dijkstra->currentDist(v);
-        check(v);
+      if (backward.nextNode() != INVALID) {
+        v = backward.processNextNode();
+        _dist_t = backward.currentDist(v);
+        check(forward, backward, v);
       }
       else {
-        runForward();
+        runForward(forward, backward);
         return;
       }
     }
@@ -87,66 +107,69 @@ private:
     if (_dmin == -1) return;
     // found a common node than we can limit the search
     while (min(_dist_s,_dist_t) < _dmin) {
-      if (_dist_s >= _dmin || _forward_dijkstra->nextNode() == INVALID) {
-        runBackward();
+      if (_dist_s >= _dmin || forward.nextNode() == INVALID) {
+        runBackward(forward, backward);
         return;
       }
       else {
-        v = _forward_dijkstra->nextNode();
-        _forward_dijkstra->processNextNode();
-        _dist_s = _forward_dijkstra->currentDist(v);
-        check(v);
+        v = forward.nextNode();
+        forward.processNextNode();
+        _dist_s = forward.currentDist(v);
+        check(forward, backward, v);
       }
-      if (_backward_dijkstra->nextNode() == INVALID || _dist_t >= _dmin) {
-        runForward();
+      if (backward.nextNode() == INVALID || _dist_t >= _dmin) {
+        runForward(forward, backward);
         return;
       }
       else {
-        v = _backward_dijkstra->nextNode();
-        _backward_dijkstra->processNextNode();
-        _dist_t = _backward_dijkstra->currentDist(v);
-        check(v);
+        v = backward.nextNode();
+        backward.processNextNode();
+        _dist_t = backward.currentDist(v);
+        check(forward, backward, v);
       }
     }
   }
 
   ///Only runs the forward search.
-  void runForward() {
+  template <typename D>
+  void runForward(D& forward, D& backward) {
     Node v;
-    while (_dmin == -1 && _forward_dijkstra->nextNode() != INVALID) {
-      v = _forward_dijkstra->processNextNode();
-      _dist_s = _forward_dijkstra->currentDist(v);
-      check(v);
+    while (_dmin == -1 && forward.nextNode() != INVALID) {
+      v = forward.processNextNode();
+      _dist_s = forward.currentDist(v);
+      check(forward, backward, v);
     }
     if (_dmin == -1) return;
-    while (_dist_s < _dmin && _forward_dijkstra->nextNode() != INVALID) {
-      v = _forward_dijkstra->processNextNode();
-      _dist_s = _forward_dijkstra->currentDist(v);
-      check(v);
+    while (_dist_s < _dmin && forward.nextNode() != INVALID) {
+      v = forward.processNextNode();
+      _dist_s = forward.currentDist(v);
+      check(forward, backward, v);
     }
   }
 
   ///Only runs the backward search.
-  void runBackward() {
+  template <typename D>
+  void runBackward(D& forward, D& backward) {
     Node v;
-    while (_dmin == -1 && _backward_dijkstra->nextNode() != INVALID) {
-      v = _backward_dijkstra->processNextNode();
-      _dist_t = _backward_dijkstra->currentDist(v);
-      check(v);
+    while (_dmin == -1 && backward.nextNode() != INVALID) {
+      v = backward.processNextNode();
+      _dist_t = backward.currentDist(v);
+      check(forward, backward, v);
     }
     if (_dmin == -1) return;
-    while (_dist_t < _dmin && _backward_dijkstra->nextNode() != INVALID) {
-      v = _backward_dijkstra->processNextNode();
-      _dist_t = _backward_dijkstra->currentDist(v);
-      check(v);
+    while (_dist_t < _dmin && backward.nextNode() != INVALID) {
+      v = backward.processNextNode();
+      _dist_t = backward.currentDist(v);
+      check(forward, backward, v);
     }
   }
 
   ///Check if a node is processed in both directions.
-  void check(Node& v) {
-    if (_forward_dijkstra->processed(v) && _backward_dijkstra->processed(v)) {
-      if ((_forward_dijkstra->currentDist(v) + _backward_dijkstra->currentDist(v) < _dmin) || (_dmin == -1)) {
-        _dmin = _forward_dijkstra->currentDist(v) + _backward_dijkstra->currentDist(v);
+  template <typename D>
+  void check(D& forward, D& backward, Node v) {
+    if (forward.processed(v) && backward.processed(v)) {
+      if ((forward.currentDist(v) + backward.currentDist(v) < _dmin) || (_dmin == -1)) {
+        _dmin = forward.currentDist(v) + backward.currentDist(v);
         _nodemin = v;
       }
     }
@@ -155,8 +178,13 @@ private:
   ///Add source.
   ///\param v The source
   void addSource(Node& v) {
-    _forward_dijkstra->clear();
-    _forward_dijkstra->addSource(v);
+    if (_query_graph != NULL) {
+      _forward_query->clear();
+      _forward_query->addSource(v);
+    } else {
+      _forward_dijkstra->clear();
+      _forward_dijkstra->addSource(v);
+    }
     _dist_s = 0;
     _source = true;
   }
@@ -164,8 +192,13 @@ private:
   ///Add target.
   ///\param v The target
   void addTarget(Node& v) {
-    _backward_dijkstra->clear();
-    _backward_dijkstra->addSource(v);
+    if (_query_graph != NULL) {
+      _backward_query->clear();
+      _backward_query->addSource(v);
+    } else {
+      _backward_dijkstra->clear();
+      _backward_dijkstra->addSource(v);
+    }
     _dist_t = 0;
     _target = true;
   }
@@ -192,37 +225,93 @@ private:
     }
   }
 
+  ///Creates the dijkstras.
+  ///\param query_graph The merged search graph, the searches run on the static graphs if it is NULL
+  void create(const QueryGraph* query_graph) {
+    _query_graph = query_graph;
+    _forward_dijkstra = NULL;
+    _backward_dijkstra = NULL;
+    _forward_query = NULL;
+    _backward_query = NULL;
+    if (_query_graph != NULL) {
+      _forward_query = new QueryDijkstra(*_query_graph, QueryArc::FORWARD);
+      _backward_query = new QueryDijkstra(*_query_graph, QueryArc::BACKWARD);
+    } else {
+      _forward_dijkstra = new Dijkstra(*_forward_graph, *_forward_cost);
+      _backward_dijkstra = new Dijkstra(*_backward_graph, *_backward_cost);
+    }
+
+    _dist_s = 0;
+    _dist_t = 0;
+    _dmin = -1;
+    _nodemin = INVALID;
+
+    _source = false;
+    _target = false;
+  }
+
 public:
 
   ///Initializes the search algorithm.
+  ///The hierarchy in chdata is only read, more searches can use it at the same time.
   ///\param chdata The CHData struct containing every necessary pointer.
-  CHSearch(CHData& chdata) {
+  ///\param query_graph The merged search graph of chdata, the searches run on the static graphs if it is NULL
+  CHSearch(const CHData& chdata, const QueryGraph* query_graph = NULL) {
     _forward_graph = chdata.forward_graph;
     _forward_cost = chdata.forward_cost;
     _backward_graph = chdata.backward_graph;
     _backward_cost = chdata.backward_cost;
+    _forward_back_arc_ref = chdata.forward_backArcRef;
+    _backward_back_arc_ref = chdata.backward_backArcRef;
+    create(query_graph);
+  }
 
-    _forward_dijkstra = new Dijkstra(*_forward_graph, *_forward_cost);
-    _backward_dijkstra = new Dijkstra(*_backward_graph, *_backward_cost);
-
-    _dist_s = 0;
-    _dist_t = 0;
-    _dmin = -1;
-    _nodemin = INVALID;
-
-    _source = false;
-    _target = false;
+  ///Initializes the search algorithm on a self-contained query graph.
+  ///The query graph is only read, more searches can use it at the same time.
+  ///\param query_graph The query graph
+  CHSearch(const QueryGraph& query_graph) {
+    _forward_graph = NULL;
+    _forward_cost = NULL;
+    _backward_graph = NULL;
+    _backward_cost = NULL;
+    _forward_back_arc_ref = NULL;
+    _backward_back_arc_ref = NULL;
+    create(&query_graph);
   }
 
   ~CHSearch() {
     delete _forward_dijkstra;
     delete _backward_dijkstra;
+    delete _forward_query;
+    delete _backward_query;
+  }
+
+  ///Stall the nodes of the searches which are reached on a shorter path through a higher node.
+  ///\param stall Whether stall-on-demand is used
+  void setStallOnDemand(bool stall) {
+    if (_query_graph != NULL) {
+      _forward_query->setStallOnDemand(stall);
+      _backward_query->setStallOnDemand(stall);
+    }
+    else if (stall) {
+      _forward_dijkstra->setStallGraph(*_backward_graph, *_backward_cost);
+      _backward_dijkstra->setStallGraph(*_forward_graph, *_forward_cost);
+    }
+    else {
+      _forward_dijkstra->clearStallGraph();
+      _backward_dijkstra->clearStallGraph();
+    }
   }
 
   ///Resets all calculated data.
   void clear() {
-    _forward_dijkstra->clear();
-    _backward_dijkstra->clear();
+    if (_query_graph != NULL) {
+      _forward_query->clear();
+      _backward_query->clear();
+    } else {
+      _forward_dijkstra->clear();
+      _backward_dijkstra->clear();
+    }
     _source = false;
     _target = false;
   }
@@ -258,7 +347,48 @@ public:
     return _dmin;
   }
 
-  ///\return The forward path
+  ///\return The merged search graph, NULL if the searches run on the static graphs
+  const QueryGraph* queryGraph() const {
+    return _query_graph;
+  }
+
+  ///\return The arc codes of the shortest path in the preprocessed graph, see CHData.
+  ///Only for searches on the static graphs.
+  vector<int> buildPackedPath() const {
+    vector<int> path;
+    vector<Arc> forward_path = buildForwardPath();
+    vector<Arc> backward_path = buildBackwardPath();
+    for (unsigned int i = 0; i < forward_path.size(); ++i) {
+      path.push_back((*_forward_back_arc_ref)[forward_path[i]]);
+    }
+    for (unsigned int i = 0; i < backward_path.size(); ++i) {
+      path.push_back((*_backward_back_arc_ref)[backward_path[i]]);
+    }
+    return path;
+  }
+
+  ///\return The shortest path containing the original arcs, unpacked by the query graph.
+  ///Only for searches on a QueryGraph.
+  vector<ListDigraph::Arc> buildQueryPath() const {
+    vector<ListDigraph::Arc> path;
+    if (_nodemin == INVALID) return path;
+    vector<Node> forward_nodes;
+    for (Node v = _nodemin; _forward_query->predArc(v) != -1; v = _forward_query->predNode(v)) {
+      forward_nodes.push_back(v);
+    }
+    for (int i = forward_nodes.size() - 1; i >= 0; --i) {
+      Node v = forward_nodes[i];
+      _query_graph->unpack(path, Graph::id(_forward_query->predNode(v)), _forward_query->predArc(v),
+        QueryArc::FORWARD);
+    }
+    for (Node v = _nodemin; _backward_query->predArc(v) != -1; v = _backward_query->predNode(v)) {
+      _query_graph->unpack(path, Graph::id(_backward_query->predNode(v)), _backward_query->predArc(v),
+        QueryArc::BACKWARD);
+    }
+    return path;
+  }
+
+  ///\return The forward path, only for searches on the static graphs
   vector<Arc> buildForwardPath() const {
     vector<Arc> path;
     if (_nodemin != INVALID) {
@@ -267,7 +397,7 @@ public:
     return path;
   }
 
-  ///\return The backward path
+  ///\return The backward path, only for searches on the static graphs
   vector<Arc> buildBackwardPath() const {
     vector<Arc> path;
     if (_nodemin != INVALID) {
@@ -0,0 +1,241 @@
+/* -*- mode: C++; indent-tabs-mode: nil; -*-
+ *
+ * This file is a part of LEMON, a generic C++ optimization library.
+ *
+ * Copyright (C) 2003-2013
+ * Egervary Jeno Kombinatorikus Optimalizalasi Kutatocsoport
+ * (Egervary Research Group on Combinatorial Optimization, EGRES).
+ *
+ * Permission to use, modify and distribute this software is granted
+ * provided that this copyright notice appears in all copies. For
+ * precise terms see the accompanying LICENSE file.
+ *
+ * This software is provided "AS IS" with no warranty of any kind,
+ * express or implied, and with no claim as to its suitability for any
+ * purpose.
+ *
+ */
+
+#ifndef CH_EDGEDIFF_PRIORITY_H
+#define CH_EDGEDIFF_PRIORITY_H
+
+#include <lemon/core.h>
+#include <vector>
+#include <lemon/list_graph.h>
+#include "Utils/EdgeDiffDijkstra.h"
+#include "Utils/ContractionSimulator.h"
+#include "Utils/IndependentSet.h"
+#include "Utils/Parallel.h"
+#include "CHData.h"
+#include "Priority.h"
+
+using namespace std;
+using namespace lemon;
+
+///The common part of the priorities using the edge difference of the simulated contractions.
+///
+///The edge differences are calculated in parallel, every thread has its own dijkstra. The neighbours
+///of the contracted nodes are collected first, then their edge differences are updated at the same
+///time, and the heap is updated in the order of the neighbours, so the order doesn't depend on
+///the thread count. The subclasses combine the values into the priority.
+///\tparam HP The heap policy of the node order and of the witness searches
+template <typename HP = BinHeapPolicy>
+class EdgeDiffPriority: public Priority {
+
+public:
+
+  typedef HP HeapPolicy;
+
+protected:
+
+  typedef ListDigraph Graph;
+  typedef Graph::Node Node;
+  typedef Graph::Arc Arc;
+  typedef Graph::OutArcIt OutArcIt;
+  typedef Graph::InArcIt InArcIt;
+  typedef Graph::ArcMap<int> Cost;
+  typedef Graph::NodeMap<int> NodeMap;
+  typedef typename HP::template Heap<NodeMap>::type Heap;
+  typedef EdgeDiffDijkstra<typename SearchHeap<Graph, HP>::type> Dijkstra;
+
+  Graph *_graph;
+  Cost *_cost;
+  ///priority
+  NodeMap _state;
+  Heap _prior;
+  ///cost of queries, search space
+  NodeMap _sp;
+  ///deleted neighbours
+  NodeMap _dn;
+  ///edgedifference
+  NodeMap _ed;
+
+  ///\param v The node
+  ///\return The priority of v calculated from the stored values
+  virtual int priority(Node v) const = 0;
+
+  ///Calculates the values of a node which don't change during the contraction.
+  ///\param v The node
+  virtual void initNode(Node v) {}
+
+private:
+
+  ///neighbours already waiting for an update
+  Graph::NodeMap<bool> _queued;
+  ///dijkstras, one for every thread
+  vector<Dijkstra*> _dijkstras;
+  ///simulates the contractions
+  ContractionSimulator _simulator;
+  ///stores the shortcuts of the next node
+  ShortcutCache *_cache;
+  ///limits of the witness searches
+  WitnessLimit _simulation_limit;
+  WitnessLimit _contraction_limit;
+
+  ///Calculates the edgedifference of the given node.
+  ///The graph is not changed, so more nodes can be evaluated at the same time using different dijkstras.
+  ///\param v The node whose edge difference will be calculated.
+  ///\param dijkstra The dijkstra used for the witness searches
+  ///\param shortcuts If it is given, the shortcuts are added to this vector
+  ///\return The edge difference
+  int edgediff(Node v, Dijkstra& dijkstra, vector<Shortcut>* shortcuts = NULL) const {
+    Simulation s = _simulator.simulate(v, dijkstra, shortcuts);
+    return s.shortcuts - s.in - s.out;
+  }
+
+  ///Calculates the edge differences of the given nodes in parallel.
+  ///\param nodes The nodes
+  void edgediffs(const vector<Node>& nodes) {
+    int k = nodes.size();
+    for (unsigned int i = 0; i < _dijkstras.size(); ++i) {
+      _dijkstras[i]->setLimit(_simulation_limit);
+    }
+#pragma omp parallel for schedule(dynamic, 64)
+    for (int i = 0; i < k; ++i) {
+      _ed[nodes[i]] = edgediff(nodes[i], *_dijkstras[threadNum()]);
+    }
+  }
+
+  ///Updates the values of a neighbour of a contracted node.
+  ///The priority is recalculated later, once for every neighbour.
+  ///\param v The contracted node
+  ///\param w The neighbour
+  ///\param neighbours The neighbours to be updated
+  void countNeighbour(Node v, Node w, vector<Node>& neighbours) {
+    // already contracted or a loop
+    if (_state[w] == -2) return;
+    _dn[w] += 1;
+    _sp[w] = max(_sp[w], _sp[v]+1);
+    if (!_queued[w]) {
+      _queued[w] = true;
+      neighbours.push_back(w);
+    }
+  }
+
+  ///Updates the priority of the neighbours of the given nodes.
+  ///\param nodes The contracted nodes
+  void updateNeighbours(const vector<Node>& nodes) {
+    vector<Node> neighbours;
+    for (unsigned int i = 0; i < nodes.size(); ++i) {
+      for (unsigned int j = 0; j < _dijkstras.size(); ++j) {
+        _dijkstras[j]->addContractedNode(nodes[i]);
+      }
+    }
+    for (unsigned int i = 0; i < nodes.size(); ++i) {
+      Node v = nodes[i];
+      for (OutArcIt e(*_graph,v); e != INVALID; ++e) {
+        countNeighbour(v, _graph->target(e), neighbours);
+      }
+      for (InArcIt e(*_graph,v); e != INVALID; ++e) {
+        countNeighbour(v, _graph->source(e), neighbours);
+      }
+    }
+    edgediffs(neighbours);
+    for (unsigned int i = 0; i < neighbours.size(); ++i) {
+      Node w = neighbours[i];
+      _queued[w] = false;
+      _prior.set(w, priority(w));
+    }
+  }
+
+public:
+
+  EdgeDiffPriority(CHData& chdata):
+  _state(*chdata.graph, -1), _prior(_state), _sp(*chdata.graph ,0), _dn(*chdata.graph, 0), _ed(*chdata.graph, 0),
+  _queued(*chdata.graph, false), _simulator(chdata, _state) {
+    _graph = chdata.graph;
+    _cost = chdata.cost;
+    _cache = NULL;
+    _simulation_limit = WitnessLimit(5);
+    for (int i = 0; i < maxThreads(); ++i) {
+      _dijkstras.push_back(new Dijkstra(*chdata.graph, *chdata.cost));
+    }
+  }
+
+  ~EdgeDiffPriority() {
+    for (unsigned int i = 0; i < _dijkstras.size(); ++i) {
+      delete _dijkstras[i];
+    }
+  }
+
+  ///Calculates the initial edge differences in parallel.
+  void init() {
+    vector<Node> nodes;
+    for (Graph::NodeIt v(*_graph); v != INVALID; ++v) {
+      nodes.push_back(v);
+    }
+    edgediffs(nodes);
+    for (unsigned int i = 0; i < nodes.size(); ++i) {
+      initNode(nodes[i]);
+      _prior.set(nodes[i], priority(nodes[i]));
+    }
+  }
+
+  Node nextNode() {
+    Node v = INVALID;
+    while (!_prior.empty()) {
+      v = _prior.top();
+      if (_cache == NULL) {
+        _dijkstras[0]->setLimit(_simulation_limit);
+        _ed[v] = edgediff(v, *_dijkstras[0]);
+      } else {
+        // the contraction uses these shortcuts, so the searches must use its limits
+        _dijkstras[0]->setLimit(_contraction_limit);
+        _ed[v] = edgediff(v, *_dijkstras[0], &_cache->record(v));
+      }
+      _prior.set(v, priority(v));
+      if (v == _prior.top()) {
+        _prior.pop();
+        return v;
+      }
+    }
+    return v;
+  }
+
+  void setCache(ShortcutCache* cache) {
+    _cache = cache;
+  }
+
+  void setWitnessLimits(const WitnessLimit& simulation, const WitnessLimit& contraction) {
+    _simulation_limit = simulation;
+    _contraction_limit = contraction;
+  }
+
+  void finalize(Node v) {
+    updateNeighbours(vector<Node>(1, v));
+  }
+
+  void nextNodes(vector<Node>& nodes) {
+    int k = nodes.size();
+    independentNodes(*_graph, _prior, nodes);
+    for (unsigned int i = k; i < nodes.size(); ++i) {
+      _prior.erase(nodes[i]);
+    }
+  }
+
+  void finalizeNodes(const vector<Node>& nodes) {
+    updateNeighbours(nodes);
+  }
+};
+
+#endif
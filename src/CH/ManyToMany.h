@@ -0,0 +1,164 @@
+/* -*- mode: C++; indent-tabs-mode: nil; -*-
+ *
+ * This file is a part of LEMON, a generic C++ optimization library.
+ *
+ * Copyright (C) 2003-2013
+ * Egervary Jeno Kombinatorikus Optimalizalasi Kutatocsoport
+ * (Egervary Research Group on Combinatorial Optimization, EGRES).
+ *
+ * Permission to use, modify and distribute this software is granted
+ * provided that this copyright notice appears in all copies. For
+ * precise terms see the accompanying LICENSE file.
+ *
+ * This software is provided "AS IS" with no warranty of any kind,
+ * express or implied, and with no claim as to its suitability for any
+ * purpose.
+ *
+ */
+#ifndef MANYTOMANY_H
+#define MANYTOMANY_H
+
+#include <vector>
+#include <lemon/list_graph.h>
+#include <lemon/static_graph.h>
+#include "CHData.h"
+#include "Utils/SearchDijkstra.h"
+#include "Utils/HeapPolicy.h"
+#include "Utils/Parallel.h"
+
+using std::vector;
+using std::pair;
+using std::make_pair;
+using lemon::ListDigraph;
+using lemon::StaticDigraph;
+using lemon::INVALID;
+
+///Calculates the distance table between a set of sources and a set of targets.
+///
+///Every target has one upward search in the backward graph, and the settled nodes get a bucket
+///entry with the target and its distance. Then every source has one upward search in the forward
+///graph, and the buckets of the settled nodes give the distances to the targets.
+///The searches of the sources and of the targets run in parallel, the hierarchy is only read.
+///\tparam HP The heap policy of the upward searches
+template <typename HP = BinHeapPolicy>
+class ManyToMany {
+
+  typedef StaticDigraph Graph;
+  typedef Graph::Node Node;
+  typedef Graph::ArcMap<int> Cost;
+  typedef SearchDijkstra<typename SearchHeap<Graph, HP>::type> Dijkstra;
+  ///A bucket entry: the index of the target and the distance from the node to it
+  typedef pair<int, int> Entry;
+
+private:
+
+  Graph *_forward_graph;
+  Graph *_backward_graph;
+  Cost *_forward_cost;
+  Cost *_backward_cost;
+  ListDigraph::NodeMap<StaticDigraph::Node> *_forward_noderef;
+  ListDigraph::NodeMap<StaticDigraph::Node> *_backward_noderef;
+
+  vector<Dijkstra*> _forward_dijkstras;
+  vector<Dijkstra*> _backward_dijkstras;
+
+  ///The first entry of the bucket of every node, indexed by the node ids
+  vector<int> _bucket_begin;
+  ///The entries of the buckets
+  vector<Entry> _buckets;
+
+  ///Runs a full upward search and collects the settled nodes with their distances.
+  void upwardSearch(Dijkstra& dijkstra, Node s, vector<Entry>& settled) const {
+    dijkstra.addSource(s);
+    while (dijkstra.nextNode() != INVALID) {
+      Node v = dijkstra.processNextNode();
+      settled.push_back(make_pair(Graph::id(v), dijkstra.currentDist(v)));
+    }
+    dijkstra.clear();
+  }
+
+  ///Runs the searches of the targets and fills the buckets.
+  void fillBuckets(const vector<ListDigraph::Node>& targets) {
+    int k = targets.size();
+    vector<vector<Entry> > spaces(k);
+#pragma omp parallel for schedule(dynamic, 16)
+    for (int j = 0; j < k; ++j) {
+      upwardSearch(*_backward_dijkstras[threadNum()], (*_backward_noderef)[targets[j]], spaces[j]);
+    }
+    int n = _backward_graph->nodeNum();
+    _bucket_begin.assign(n + 1, 0);
+    for (int j = 0; j < k; ++j) {
+      for (unsigned int i = 0; i < spaces[j].size(); ++i) {
+        ++_bucket_begin[spaces[j][i].first + 1];
+      }
+    }
+    for (int v = 0; v < n; ++v) {
+      _bucket_begin[v + 1] += _bucket_begin[v];
+    }
+    _buckets.resize(_bucket_begin[n]);
+    vector<int> pos(_bucket_begin.begin(), _bucket_begin.end() - 1);
+    for (int j = 0; j < k; ++j) {
+      for (unsigned int i = 0; i < spaces[j].size(); ++i) {
+        _buckets[pos[spaces[j][i].first]++] = make_pair(j, spaces[j][i].second);
+      }
+    }
+  }
+
+public:
+
+  ///Initializes the algorithm.
+  ///\param chdata The CHData containing a preprocessed graph
+  ManyToMany(const CHData& chdata) {
+    _forward_graph = chdata.forward_graph;
+    _backward_graph = chdata.backward_graph;
+    _forward_cost = chdata.forward_cost;
+    _backward_cost = chdata.backward_cost;
+    _forward_noderef = chdata.forward_nodeRef;
+    _backward_noderef = chdata.backward_nodeRef;
+    for (int t = 0; t < maxThreads(); ++t) {
+      _forward_dijkstras.push_back(new Dijkstra(*_forward_graph, *_forward_cost));
+      _backward_dijkstras.push_back(new Dijkstra(*_backward_graph, *_backward_cost));
+    }
+  }
+
+  ~ManyToMany() {
+    for (unsigned int t = 0; t < _forward_dijkstras.size(); ++t) {
+      delete _forward_dijkstras[t];
+      delete _backward_dijkstras[t];
+    }
+  }
+
+  ///Calculates the distance table.
+  ///\param sources The sources in the original graph
+  ///\param targets The targets in the original graph
+  ///\param dist The table, the distance from sources[i] to targets[j] is written to
+  ///dist[i * targets.size() + j], -1 if the target can't be reached
+  void run(const vector<ListDigraph::Node>& sources, const vector<ListDigraph::Node>& targets, int* dist) {
+    int k = targets.size();
+    int m = sources.size();
+    fillBuckets(targets);
+#pragma omp parallel
+    {
+      vector<Entry> settled;
+#pragma omp for schedule(dynamic, 16)
+      for (int i = 0; i < m; ++i) {
+        int* row = dist + static_cast<long>(i) * k;
+        for (int j = 0; j < k; ++j) {
+          row[j] = -1;
+        }
+        settled.clear();
+        upwardSearch(*_forward_dijkstras[threadNum()], (*_forward_noderef)[sources[i]], settled);
+        for (unsigned int s = 0; s < settled.size(); ++s) {
+          int v = settled[s].first;
+          for (int b = _bucket_begin[v]; b < _bucket_begin[v + 1]; ++b) {
+            int d = settled[s].second + _buckets[b].second;
+            int& cell = row[_buckets[b].first];
+            if (cell == -1 || d < cell) cell = d;
+          }
+        }
+      }
+    }
+  }
+};
+
+#endif
@@ -0,0 +1,107 @@
+/* -*- mode: C++; indent-tabs-mode: nil; -*-
+ *
+ * This file is a part of LEMON, a generic C++ optimization library.
+ *
+ * Copyright (C) 2003-2013
+ * Egervary Jeno Kombinatorikus Optimalizalasi Kutatocsoport
+ * (Egervary Research Group on Combinatorial Optimization, EGRES).
+ *
+ * Permission to use, modify and distribute this software is granted
+ * provided that this copyright notice appears in all copies. For
+ * precise terms see the accompanying LICENSE file.
+ *
+ * This software is provided "AS IS" with no warranty of any kind,
+ * express or implied, and with no claim as to its suitability for any
+ * purpose.
+ *
+ */
+#ifndef MAPPEDCH_H
+#define MAPPEDCH_H
+
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <lemon/error.h>
+#include "Utils/CHFileFormat.h"
+
+using std::string;
+
+///A binary CH file written by CHFileWriter, mapped into memory.
+///
+///The arrays are used directly from the mapping, so opening the file takes the same time for any
+///size and the pages are shared by the processes using the same file. MappedCHSearch runs queries on it.
+class MappedCH {
+
+private:
+
+  void *_data;
+  long long _size;
+  const CHFileHeader *_header;
+
+public:
+
+  ///Maps a file into memory.
+  ///\param filename The name of the file
+  MappedCH(const char* filename) {
+    int fd = open(filename, O_RDONLY);
+    if (fd == -1) throw lemon::IoError("Cannot open file", filename);
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+      close(fd);
+      throw lemon::IoError("Cannot read file", filename);
+    }
+    _size = st.st_size;
+    _data = _size < static_cast<long long>(sizeof(CHFileHeader)) ? MAP_FAILED :
+      mmap(NULL, _size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (_data == MAP_FAILED) throw lemon::IoError("Cannot map file", filename);
+    _header = static_cast<const CHFileHeader*>(_data);
+    CHFileHeader layout = *_header;
+    layout.layout();
+    if (!_header->valid() || layout.size != _size ||
+        memcmp(layout.offset, _header->offset, sizeof(layout.offset)) != 0) {
+      munmap(_data, _size);
+      throw lemon::FormatError("Not a compatible CH file", filename);
+    }
+  }
+
+  ~MappedCH() {
+    munmap(_data, _size);
+  }
+
+  ///\param section The section of the file, see CHFileHeader
+  ///\return The array of the section
+  const int* section(CHFileHeader::Section section) const {
+    return reinterpret_cast<const int*>(static_cast<const char*>(_data) + _header->offset[section]);
+  }
+
+  ///\return The number of nodes
+  int nodes() const {
+    return _header->nodes;
+  }
+
+  ///\return The largest node id of the original graph
+  int maxNodeId() const {
+    return _header->max_node_id;
+  }
+
+  ///\return The number of arcs in the forward graph
+  int forwardArcs() const {
+    return _header->forward_arcs;
+  }
+
+  ///\return The number of arcs in the backward graph
+  int backwardArcs() const {
+    return _header->backward_arcs;
+  }
+
+  ///\param v A node id of the original graph
+  ///\return The node of the search graphs, -1 if the id is not used
+  int nodeRef(int v) const {
+    return section(CHFileHeader::NODE_REF)[v];
+  }
+};
+
+#endif
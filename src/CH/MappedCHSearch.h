@@ -0,0 +1,131 @@
+/* -*- mode: C++; indent-tabs-mode: nil; -*-
+ *
+ * This file is a part of LEMON, a generic C++ optimization library.
+ *
+ * Copyright (C) 2003-2013
+ * Egervary Jeno Kombinatorikus Optimalizalasi Kutatocsoport
+ * (Egervary Research Group on Combinatorial Optimization, EGRES).
+ *
+ * Permission to use, modify and distribute this software is granted
+ * provided that this copyright notice appears in all copies. For
+ * precise terms see the accompanying LICENSE file.
+ *
+ * This software is provided "AS IS" with no warranty of any kind,
+ * express or implied, and with no claim as to its suitability for any
+ * purpose.
+ *
+ */
+#ifndef MAPPEDCHSEARCH_H
+#define MAPPEDCHSEARCH_H
+
+#include <vector>
+#include "MappedCH.h"
+#include "Utils/ArrayDijkstra.h"
+
+using std::vector;
+
+///Runs queries on a MappedCH.
+///
+///The searches only read the mapped arrays, so more instances can use the same MappedCH
+///from different threads. The nodes and arcs are given by their ids in the original graph.
+class MappedCHSearch {
+
+private:
+
+  const MappedCH *_ch;
+  ArrayDijkstra _forward_dijkstra;
+  ArrayDijkstra _backward_dijkstra;
+  int _dmin;
+  int _nodemin;
+
+  ///Recursively unpack the new arcs in the path.
+  ///\param path The partially completed path of original arcs
+  ///\param code The arc code of the current arc, see CHFileHeader
+  void unpack(vector<int>& path, int code) const {
+    if (code >= 0) {
+      path.push_back(code);
+    } else {
+      unpack(path, _ch->section(CHFileHeader::PACK_FIRST)[-1 - code]);
+      unpack(path, _ch->section(CHFileHeader::PACK_SECOND)[-1 - code]);
+    }
+  }
+
+  ///Check if a node reached in both directions gives a shorter path.
+  void check(int v) {
+    if (_forward_dijkstra.reached(v) && _backward_dijkstra.reached(v)) {
+      int d = _forward_dijkstra.currentDist(v) + _backward_dijkstra.currentDist(v);
+      if (_dmin == -1 || d < _dmin) {
+        _dmin = d;
+        _nodemin = v;
+      }
+    }
+  }
+
+  ///\return Whether the search can still improve the distance
+  bool open(const ArrayDijkstra& dijkstra) const {
+    return !dijkstra.empty() && (_dmin == -1 || dijkstra.nextDist() < _dmin);
+  }
+
+public:
+
+  ///Initializes the search algorithm.
+  ///\param ch The mapped hierarchy
+  MappedCHSearch(const MappedCH& ch):
+    _ch(&ch),
+    _forward_dijkstra(ch.nodes(), ch.section(CHFileHeader::FORWARD_BEGIN), ch.section(CHFileHeader::FORWARD_HEAD),
+      ch.section(CHFileHeader::FORWARD_COST)),
+    _backward_dijkstra(ch.nodes(), ch.section(CHFileHeader::BACKWARD_BEGIN), ch.section(CHFileHeader::BACKWARD_HEAD),
+      ch.section(CHFileHeader::BACKWARD_COST)) {
+    _dmin = -1;
+    _nodemin = -1;
+  }
+
+  ///Run the algorithm between the given source and target.
+  ///If an id is not a node of the original graph, the target can't be reached.
+  ///\param s The node id of the source in the original graph
+  ///\param t The node id of the target in the original graph
+  void run(int s, int t) {
+    _forward_dijkstra.clear();
+    _backward_dijkstra.clear();
+    _dmin = -1;
+    _nodemin = -1;
+    if (s < 0 || s > _ch->maxNodeId() || t < 0 || t > _ch->maxNodeId()) return;
+    int fs = _ch->nodeRef(s);
+    int bt = _ch->nodeRef(t);
+    if (fs == -1 || bt == -1) return;
+    _forward_dijkstra.addSource(fs);
+    _backward_dijkstra.addSource(bt);
+    bool forward = true;
+    while (open(_forward_dijkstra) || open(_backward_dijkstra)) {
+      if (!open(forward ? _forward_dijkstra : _backward_dijkstra)) forward = !forward;
+      check(forward ? _forward_dijkstra.processNextNode() : _backward_dijkstra.processNextNode());
+      forward = !forward;
+    }
+  }
+
+  ///\return The previously calculated distance, -1 if the target can't be reached
+  int dist() const {
+    return _dmin;
+  }
+
+  ///\return The arc ids of the shortest path in the original graph
+  vector<int> getPath() const {
+    vector<int> path;
+    if (_nodemin == -1) return path;
+    const int *forward_arc = _ch->section(CHFileHeader::FORWARD_ARC);
+    const int *backward_arc = _ch->section(CHFileHeader::BACKWARD_ARC);
+    vector<int> forward_path;
+    for (int v = _nodemin; _forward_dijkstra.predArc(v) != -1; v = _forward_dijkstra.predNode(v)) {
+      forward_path.push_back(forward_arc[_forward_dijkstra.predArc(v)]);
+    }
+    for (int i = forward_path.size() - 1; i >= 0; --i) {
+      unpack(path, forward_path[i]);
+    }
+    for (int v = _nodemin; _backward_dijkstra.predArc(v) != -1; v = _backward_dijkstra.predNode(v)) {
+      unpack(path, backward_arc[_backward_dijkstra.predArc(v)]);
+    }
+    return path;
+  }
+};
+
+#endif
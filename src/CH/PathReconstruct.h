@@ -22,58 +22,47 @@
 #include <vector>
 #include <lemon/list_graph.h>
 #include <lemon/static_graph.h>
+#include "CHData.h"
 
 using std::vector;
-using std::pair;
 using lemon::ListDigraph;
 using lemon::StaticDigraph;
 using lemon::INVALID;
 
 ///A class used to reconstruct the paths from a CHSearch.
+///\tparam HP The heap policy of the CHSearch
+template <typename HP = BinHeapPolicy>
 class PathReconstruct {
 
 private:
 
-  CHSearch *_chsearch;
-  ListDigraph::ArcMap<pair<ListDigraph::Arc, ListDigraph::Arc> > *_pack;
-
-  StaticDigraph::ArcMap<ListDigraph::Arc> *_forward_back_arc_ref;
-  StaticDigraph::ArcMap<ListDigraph::Arc> *_backward_back_arc_ref;
-
-  ///Recursively unpack the new arcs in the path.
-  ///\param path The partially completed path of original arcs
-  ///\param e The current arc
-  void unpack(vector<ListDigraph::Arc>& path, ListDigraph::Arc e) const {
-    if ((*_pack)[e].first == INVALID) {
-      path.push_back(e);
-    } else {
-      unpack(path, (*_pack)[e].first);
-      unpack(path, (*_pack)[e].second);
-    }
-  }
+  CHSearch<HP> *_chsearch;
+  const CHData *_data;
 
 public:
 
   ///Initializes the references.
   ///\param chdata The CHData containing every necessary pointer
   ///\param _chsearch The CHSearch class used to find the shortest path
-  PathReconstruct(CHData& chdata, CHSearch& chsearch):
+  PathReconstruct(const CHData& chdata, CHSearch<HP>& chsearch):
     _chsearch(&chsearch) {
-    _pack = chdata.pack;
-    _forward_back_arc_ref = chdata.forward_backArcRef;
-    _backward_back_arc_ref = chdata.backward_backArcRef;
+    _data = &chdata;
+  }
+
+  ///Initializes the references for a CHSearch on a self-contained QueryGraph.
+  ///\param _chsearch The CHSearch class used to find the shortest path
+  PathReconstruct(CHSearch<HP>& chsearch):
+    _chsearch(&chsearch) {
+    _data = NULL;
   }
 
   ///\return The sortest path containing the original arcs
   vector<ListDigraph::Arc> getPath() const {
+    if (_chsearch->queryGraph() != NULL) return _chsearch->buildQueryPath();
     vector<ListDigraph::Arc> path;
-    vector<StaticDigraph::Arc> forward_path = _chsearch->buildForwardPath();
-    vector<StaticDigraph::Arc> backward_path = _chsearch->buildBackwardPath();
-    for (unsigned int i = 0; i < forward_path.size(); ++i) {
-      unpack(path, (*_forward_back_arc_ref)[forward_path[i]]);
-    }
-    for (unsigned int i = 0; i < backward_path.size(); ++i) {
-      unpack(path, (*_backward_back_arc_ref)[backward_path[i]]);
+    vector<int> packed_path = _chsearch->buildPackedPath();
+    for (unsigned int i = 0; i < packed_path.size(); ++i) {
+      _data->unpack(path, packed_path[i]);
     }
     return path;
   }
@@ -0,0 +1,293 @@
+/* -*- mode: C++; indent-tabs-mode: nil; -*-
+ *
+ * This file is a part of LEMON, a generic C++ optimization library.
+ *
+ * Copyright (C) 2003-2013
+ * Egervary Jeno Kombinatorikus Optimalizalasi Kutatocsoport
+ * (Egervary Research Group on Combinatorial Optimization, EGRES).
+ *
+ * Permission to use, modify and distribute this software is granted
+ * provided that this copyright notice appears in all copies. For
+ * precise terms see the accompanying LICENSE file.
+ *
+ * This software is provided "AS IS" with no warranty of any kind,
+ * express or implied, and with no claim as to its suitability for any
+ * purpose.
+ *
+ */
+#ifndef PHAST_H
+#define PHAST_H
+
+#include <vector>
+#include <climits>
+#include <lemon/list_graph.h>
+#include <lemon/static_graph.h>
+#include "CHData.h"
+#include "Utils/SearchDijkstra.h"
+#include "Utils/HeapPolicy.h"
+#include "Utils/MinPlus.h"
+
+using std::vector;
+using lemon::ListDigraph;
+using lemon::StaticDigraph;
+using lemon::INVALID;
+
+///Calculates the distances from a source to every node (PHAST).
+///
+///An upward search in the forward graph gives the distances of the nodes above the source.
+///Then the nodes are swept in descending contraction order, and every node relaxes its arcs
+///from the higher nodes, which are the out arcs of the backward graph. These nodes are already
+///final, so one sweep gives the distances of all nodes.
+///
+///The parallel variant sweeps the nodes in levels: a level only depends on the earlier levels,
+///so the nodes of a level are processed at the same time.
+///
+///More trees can be calculated in one sweep. Then the distances of a node are stored next to each
+///other, and an arc is relaxed for every tree with one SIMD kernel chosen by the CPU features.
+///\tparam HP The heap policy of the upward search
+template <typename HP = BinHeapPolicy>
+class Phast {
+
+  typedef StaticDigraph Graph;
+  typedef Graph::Node Node;
+  typedef Graph::Arc Arc;
+  typedef Graph::OutArcIt OutArcIt;
+  typedef Graph::ArcMap<int> Cost;
+  typedef SearchDijkstra<typename SearchHeap<Graph, HP>::type> Dijkstra;
+
+private:
+
+  Graph *_forward_graph;
+  Graph *_backward_graph;
+  Cost *_backward_cost;
+  ListDigraph::NodeMap<StaticDigraph::Node> *_forward_noderef;
+  Graph::ArcMap<int> *_forward_back_arc_ref;
+  Graph::ArcMap<int> *_backward_back_arc_ref;
+  const CHData *_data;
+
+  Dijkstra _dijkstra;
+
+  ///The node ids in descending contraction order
+  vector<int> _sweep;
+  ///The node ids ordered by level, the levels are in descending contraction order as well
+  vector<int> _level_nodes;
+  ///The first node of every level in _level_nodes
+  vector<int> _level_begin;
+
+  ///The distances indexed by the node ids of the search graphs
+  vector<int> _dist;
+  bool _parents;
+  ///The arc code of the arc of the hierarchy into every node on the shortest path
+  vector<int> _pred;
+  ///The node before every node on the shortest path, -1 for the source and the unreached nodes
+  vector<int> _pred_node;
+
+  ///The distance of the unreached nodes in the trees, the sums with it don't overflow
+  static const int UNREACHED = INT_MAX / 2;
+  MinPlusKernel _kernel;
+  ///The number of trees of the last multi-source run
+  int _k;
+  ///The distances of the trees, k values per node indexed by the node ids
+  vector<int> _kdist;
+
+  ///Computes the levels of the nodes for the parallel sweep.
+  void initLevels() {
+    int n = _sweep.size();
+    vector<int> level(n, 0);
+    int levels = 0;
+    for (int i = 0; i < n; ++i) {
+      int v = _sweep[i];
+      for (OutArcIt e(*_backward_graph, _backward_graph->nodeFromId(v)); e != INVALID; ++e) {
+        int l = level[Graph::id(_backward_graph->target(e))] + 1;
+        if (l > level[v]) level[v] = l;
+      }
+      if (level[v] + 1 > levels) levels = level[v] + 1;
+    }
+    _level_begin.assign(levels + 1, 0);
+    for (int v = 0; v < n; ++v) {
+      ++_level_begin[level[v] + 1];
+    }
+    for (int l = 0; l < levels; ++l) {
+      _level_begin[l + 1] += _level_begin[l];
+    }
+    _level_nodes.resize(n);
+    vector<int> pos(_level_begin.begin(), _level_begin.end() - 1);
+    for (int i = 0; i < n; ++i) {
+      _level_nodes[pos[level[_sweep[i]]]++] = _sweep[i];
+    }
+  }
+
+  ///Runs the upward search from the source.
+  void upward(ListDigraph::Node s) {
+    _dist.assign(_dist.size(), INT_MAX);
+    if (_parents) _pred_node.assign(_pred_node.size(), -1);
+    _dijkstra.addSource((*_forward_noderef)[s]);
+    while (_dijkstra.nextNode() != INVALID) {
+      Node v = _dijkstra.processNextNode();
+      _dist[Graph::id(v)] = _dijkstra.currentDist(v);
+      if (_parents && _dijkstra.predArc(v) != INVALID) {
+        _pred[Graph::id(v)] = (*_forward_back_arc_ref)[_dijkstra.predArc(v)];
+        _pred_node[Graph::id(v)] = Graph::id(_forward_graph->source(_dijkstra.predArc(v)));
+      }
+    }
+    _dijkstra.clear();
+  }
+
+  ///Relaxes the arcs from the higher nodes into a node.
+  void relax(int v) {
+    int d = _dist[v];
+    Arc best = INVALID;
+    for (OutArcIt e(*_backward_graph, _backward_graph->nodeFromId(v)); e != INVALID; ++e) {
+      int du = _dist[Graph::id(_backward_graph->target(e))];
+      if (du != INT_MAX && du + (*_backward_cost)[e] < d) {
+        d = du + (*_backward_cost)[e];
+        best = e;
+      }
+    }
+    _dist[v] = d;
+    if (_parents && best != INVALID) {
+      _pred[v] = (*_backward_back_arc_ref)[best];
+      _pred_node[v] = Graph::id(_backward_graph->target(best));
+    }
+  }
+
+  ///Relaxes the arcs from the higher nodes into a node for every tree.
+  void relaxTrees(int v) {
+    int *dv = &_kdist[static_cast<long>(v) * _k];
+    for (OutArcIt e(*_backward_graph, _backward_graph->nodeFromId(v)); e != INVALID; ++e) {
+      const int *du = &_kdist[static_cast<long>(Graph::id(_backward_graph->target(e))) * _k];
+      _kernel(dv, du, (*_backward_cost)[e], _k);
+    }
+  }
+
+public:
+
+  ///Initializes the algorithm.
+  ///\param chdata The CHData containing a preprocessed graph and its contraction order
+  Phast(const CHData& chdata):
+    _dijkstra(*chdata.forward_graph, *chdata.forward_cost) {
+    _forward_graph = chdata.forward_graph;
+    _backward_graph = chdata.backward_graph;
+    _backward_cost = chdata.backward_cost;
+    _forward_noderef = chdata.forward_nodeRef;
+    _forward_back_arc_ref = chdata.forward_backArcRef;
+    _backward_back_arc_ref = chdata.backward_backArcRef;
+    _data = &chdata;
+    _parents = false;
+    _kernel = minPlusKernel();
+    _k = 0;
+    const vector<int>& order = *chdata.order;
+    for (int i = order.size() - 1; i >= 0; --i) {
+      _sweep.push_back(Graph::id((*_forward_noderef)[chdata.graph->nodeFromId(order[i])]));
+    }
+    _dist.resize(_sweep.size());
+    initLevels();
+  }
+
+  ///Stores the arcs of the shortest path tree.
+  ///\param parents Whether the arcs are stored
+  void setParents(bool parents) {
+    _parents = parents;
+    _pred.resize(parents ? _sweep.size() : 0);
+    _pred_node.resize(parents ? _sweep.size() : 0);
+  }
+
+  ///Calculates the distances from the source.
+  ///\param s The source in the original graph
+  void run(ListDigraph::Node s) {
+    upward(s);
+    for (unsigned int i = 0; i < _sweep.size(); ++i) {
+      relax(_sweep[i]);
+    }
+  }
+
+  ///Calculates the distances from the source, the nodes of a level are processed in parallel.
+  ///\param s The source in the original graph
+  void runParallel(ListDigraph::Node s) {
+    upward(s);
+    for (unsigned int l = 0; l + 1 < _level_begin.size(); ++l) {
+      int first = _level_begin[l];
+      int last = _level_begin[l + 1];
+#pragma omp parallel for schedule(static) if (last - first > 1000)
+      for (int i = first; i < last; ++i) {
+        relax(_level_nodes[i]);
+      }
+    }
+  }
+
+  ///Calculates the distances from more sources in one sweep.
+  ///The sweep is the fastest if the number of sources is a multiple of 8.
+  ///\param sources The sources in the original graph
+  ///\param parallel Whether the nodes of a level are processed in parallel
+  void run(const vector<ListDigraph::Node>& sources, bool parallel = false) {
+    _k = sources.size();
+    _kdist.assign(_sweep.size() * _k, static_cast<int>(UNREACHED));
+    for (int i = 0; i < _k; ++i) {
+      _dijkstra.addSource((*_forward_noderef)[sources[i]]);
+      while (_dijkstra.nextNode() != INVALID) {
+        Node v = _dijkstra.processNextNode();
+        _kdist[static_cast<long>(Graph::id(v)) * _k + i] = _dijkstra.currentDist(v);
+      }
+      _dijkstra.clear();
+    }
+    if (!parallel) {
+      for (unsigned int i = 0; i < _sweep.size(); ++i) {
+        relaxTrees(_sweep[i]);
+      }
+      return;
+    }
+    for (unsigned int l = 0; l + 1 < _level_begin.size(); ++l) {
+      int first = _level_begin[l];
+      int last = _level_begin[l + 1];
+#pragma omp parallel for schedule(static) if (last - first > 1000)
+      for (int i = first; i < last; ++i) {
+        relaxTrees(_level_nodes[i]);
+      }
+    }
+  }
+
+  ///\param i The index of the source in the last multi-source run
+  ///\param v A node of the original graph
+  ///\return The distance of v from the source, -1 if v can't be reached
+  int dist(int i, ListDigraph::Node v) const {
+    int d = _kdist[static_cast<long>(Graph::id((*_forward_noderef)[v])) * _k + i];
+    return d >= UNREACHED ? -1 : d;
+  }
+
+  ///\param v A node of the original graph
+  ///\return The distance of v from the source, -1 if v can't be reached
+  int dist(ListDigraph::Node v) const {
+    int d = _dist[Graph::id((*_forward_noderef)[v])];
+    return d == INT_MAX ? -1 : d;
+  }
+
+  ///\param v A node of the original graph
+  ///\return The last arc of the shortest path to v. INVALID for the source and the unreachable
+  ///nodes, or if the parents are not stored.
+  ListDigraph::Arc predArc(ListDigraph::Node v) const {
+    if (!_parents) return INVALID;
+    int u = Graph::id((*_forward_noderef)[v]);
+    if (_pred_node[u] == -1) return INVALID;
+    vector<ListDigraph::Arc> path;
+    _data->unpack(path, _pred[u]);
+    return path.back();
+  }
+
+  ///\param v A node of the original graph
+  ///\return The arcs of the shortest path from the source to v, empty for the source and the
+  ///unreachable nodes, or if the parents are not stored.
+  vector<ListDigraph::Arc> getPath(ListDigraph::Node v) const {
+    vector<ListDigraph::Arc> path;
+    if (!_parents) return path;
+    vector<int> packed_path;
+    for (int u = Graph::id((*_forward_noderef)[v]); _pred_node[u] != -1; u = _pred_node[u]) {
+      packed_path.push_back(_pred[u]);
+    }
+    for (int i = packed_path.size() - 1; i >= 0; --i) {
+      _data->unpack(path, packed_path[i]);
+    }
+    return path;
+  }
+};
+
+#endif
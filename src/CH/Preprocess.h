@@ -23,8 +23,14 @@
 #include <lemon/core.h>
 #include <lemon/list_graph.h>
 #include <lemon/static_graph.h>
-#include <lemon/adaptors.h>
 #include "Utils/ContractDijkstra.h"
+#include "Utils/ContractionGraph.h"
+#include "Utils/Shortcut.h"
+#include "Utils/ShortcutCache.h"
+#include "Utils/WitnessPolicy.h"
+#include "Utils/SearchGraphBuffer.h"
+#include "Utils/HeapPolicy.h"
+#include "Utils/Parallel.h"
 #include "CHData.h"
 
 /*
@@ -36,14 +42,15 @@ using std::make_pair;
 using lemon::ListDigraph;
 using lemon::rnd;
 using lemon::StaticDigraph;
-using lemon::SubDigraph;
 */
 
 using namespace std;
 using namespace lemon;
 
 ///The class used to preprocess the graph.
-template <class Prior>
+///\tparam Prior The priority giving the order of the nodes
+///\tparam HP The heap policy of the witness searches, the policy of the priority by default
+template <class Prior, typename HP = typename Prior::HeapPolicy>
 class Preprocess {
 
   typedef ListDigraph Graph;
@@ -53,8 +60,8 @@ class Preprocess {
   typedef Graph::InArcIt InArcIt;
   typedef Graph::ArcMap<int> Cost;
   typedef Graph::NodeMap<int> NodeMap;
-
-  typedef SubDigraph<Graph, Graph::NodeMap<bool>, Graph::ArcMap<bool> > MySubDigraph;
+  typedef ContractDijkstra<Graph, typename SearchHeap<Graph, HP>::type> Dijkstra;
+  typedef ContractDijkstra<ContractionGraph, typename SearchHeap<ContractionGraph, HP>::type> CGDijkstra;
 
 private:
 
@@ -68,113 +75,309 @@ private:
   Prior _priority;
   NodeMap _searchorder;
 
-  ListDigraph::ArcMap<pair<ListDigraph::Arc,ListDigraph::Arc> > *_pack;
+  vector<PackedArc> *_pack;
+  ///The arc code of the arcs, see CHData
+  Graph::ArcMap<int> _code;
+  ///True for the arcs added as shortcuts, they are erased when their lower end is finalized
+  Graph::ArcMap<bool> _added;
+  ///The number of original arcs represented by the arcs, see CHData
+  Cost _hops;
+
+  Dijkstra _dijkstra;
+  ///The arcs of the search graphs, added when their lower end is contracted
+  SearchGraphBuffer _forward_buffer;
+  SearchGraphBuffer _backward_buffer;
+  ShortcutCache _cache;
+
+  ///The working graph of the contraction if it is used instead of the ListDigraph
+  ContractionGraph *_cgraph;
+  CGDijkstra *_cgdijkstra;
+
+  bool _parallel;
+  bool _use_cgraph;
+
+  WitnessPolicy _policy;
+  ///The number of arcs between not contracted nodes
+  int _live_arcs;
+  ///The number of not contracted nodes
+  int _remaining;
+
+  ///\return The ListDigraph arc
+  static Arc origArc(const Graph&, Arc e) {
+    return e;
+  }
+
+  ///\return The ListDigraph arc represented by the arc of the contraction graph
+  static Arc origArc(const ContractionGraph& g, ContractionGraph::Arc e) {
+    return g.origArc(e);
+  }
+
+  ///Runs a witness search from the source of an in arc of the contracted node.
+  ///The search doesn't change the graph, so it can be run on more threads at the same time.
+  ///\param g The graph the search runs on
+  ///\param cost The arc costs
+  ///\param dijkstra The dijkstra used for the search
+  ///\param v The node to be contracted
+  ///\param e The in arc of v
+  ///\param shortcuts The necessary shortcuts are added to this vector
+  template <typename G, typename D>
+  void witnessSearch(const G& g, const typename G::template ArcMap<int>& cost, D& dijkstra,
+                     Node v, typename G::Arc e, vector<Shortcut>& shortcuts) const {
+    for (typename G::OutArcIt f(g, v); f != INVALID; ++f) {
+      Node x = g.target(f);
+      if (_finalized[x]) continue;
+      if(g.id(x) == g.id(v)) continue;
+      dijkstra.addTarget(x, cost[e] + cost[f]);
+    }
+    dijkstra.witnessSearch(g.source(e));
+    for (typename G::OutArcIt f(g, v); f != INVALID; ++f) {
+      Node x = g.target(f);
+      if (_finalized[x]) continue;
+      if(g.id(x) == g.id(v)) continue;
+      if (!dijkstra.witnessed(x, cost[e] + cost[f])) {
+        shortcuts.push_back(Shortcut(origArc(g, e), origArc(g, f), cost[e] + cost[f]));
+      }
+    }
+    dijkstra.clear();
+  }
+
+  ///\return The arc from w to x or INVALID if there is no such arc
+  Arc findArc(Node w, Node x) const {
+    if (_cgraph != NULL) return _cgraph->findArc(w, x);
+    for (OutArcIt r(*_graph, w); r != INVALID; ++r) {
+      if (_graph->id(_graph->target(r)) == _graph->id(x)) return r;
+    }
+    return INVALID;
+  }
+
+  ///Adds the shortcuts to the graph or decreases the cost of the existing arcs.
+  ///\param shortcuts The shortcuts
+  void addShortcuts(const vector<Shortcut>& shortcuts) {
+    for (unsigned int i = 0; i < shortcuts.size(); ++i) {
+      const Shortcut& s = shortcuts[i];
+      Node w = _graph->source(s.first);
+      Node x = _graph->target(s.second);
+      Arc t = findArc(w, x);
+      if (t == INVALID) {
+        t = _graph->addArc(w, x);
+        _added[t] = true;
+        _code[t] = 0;
+        ++_live_arcs;
+      }
+      else if ((*_cost)[t] <= s.cost) {
+        continue;
+      }
+      (*_cost)[t] = s.cost;
+      _hops[t] = _hops[s.first] + _hops[s.second];
+      PackedArc packed(_code[s.first], _code[s.second], _graph->id(_graph->target(s.first)));
+      if (_code[t] < 0) {
+        (*_pack)[-1 - _code[t]] = packed;
+      } else {
+        _code[t] = -1 - static_cast<int>(_pack->size());
+        _pack->push_back(packed);
+      }
+      if (_cgraph != NULL) _cgraph->setArc(w, x, s.cost, t);
+      _cache.touch(w);
+      _cache.touch(x);
+    }
+  }
+
+  ///Finds the shortcuts needed for contracting the given node without changing the graph.
+  ///\param g The graph the searches run on
+  ///\param cost The arc costs
+  ///\param dijkstra The dijkstra used for the witness searches
+  ///\param v The node to be contracted
+  ///\param shortcuts The necessary shortcuts are added to this vector
+  template <typename G, typename D>
+  void findShortcuts(const G& g, const typename G::template ArcMap<int>& cost, D& dijkstra,
+                     Node v, vector<Shortcut>& shortcuts) const {
+    for (typename G::InArcIt e(g, v); e != INVALID; ++e) {
+      Node w = g.source(e);
+      if (_finalized[w]) continue;
+      if(g.id(w) == g.id(v)) continue;
+      witnessSearch(g, cost, dijkstra, v, e, shortcuts);
+    }
+  }
 
-  ContractDijkstra _dijkstra;
+  ///Runs the witness searches from the in neighbours of the node, and adds the shortcuts after every search.
+  template <typename G, typename D>
+  void contract(const G& g, const typename G::template ArcMap<int>& cost, D& dijkstra, Node v) {
+    vector<Shortcut> shortcuts;
+    // determining new arcs
+    for (typename G::InArcIt e(g, v); e != INVALID; ++e) {
+      Node w = g.source(e);
+      if (_finalized[w]) continue;
+      if(g.id(w) == g.id(v)) continue;
+      shortcuts.clear();
+      witnessSearch(g, cost, dijkstra, v, e, shortcuts);
+      addShortcuts(shortcuts);
+    }
+  }
 
   ///Contracts the given node.
+  ///If the shortcuts of the node were found while calculating its priority, they are added without new witness searches.
   ///\param v The node to be contracted
   void contract(Node& v) {
-    // max cost of the out arcs
-    int max_out = 0;
     // "delete" node from further searches
     _dijkstra.addContractedNode(v);
+    if (_cgdijkstra != NULL) _cgdijkstra->addContractedNode(v);
+    const vector<Shortcut>* cached = _cache.find(v);
+    if (cached != NULL) {
+      addShortcuts(*cached);
+    } else if (_cgraph != NULL) {
+      contract(*_cgraph, _cgraph->costMap(), *_cgdijkstra, v);
+    } else {
+      contract(*_graph, *_cost, _dijkstra, v);
+    }
+    _cache.erase(v);
+    // the neighbours lose their arcs to v
     for (OutArcIt e(*_graph, v); e != INVALID; ++e) {
-      if (_finalized[_graph->target(e)]) continue;
-      if ((*_cost)[e] > max_out) max_out = (*_cost)[e];
+      _cache.touch(_graph->target(e));
     }
-    // determining new arcs
     for (InArcIt e(*_graph, v); e != INVALID; ++e) {
-      Node w = _graph->source(e);
-      if (_finalized[w]) continue;
-      if(_graph->id(w) == _graph->id(v)) continue;
-      int limit = (*_cost)[e] + max_out;
-      _dijkstra.addSource(w);
-      while(_dijkstra.nextNode() != INVALID && _dijkstra.currentDist(_dijkstra.nextNode()) <= limit) {
-        _dijkstra.processNextNode();
-      }
-      for (OutArcIt f(*_graph, v); f != INVALID; ++f) {
-        if (_finalized[_graph->target(f)]) continue;
-        if(_graph->id(_graph->target(f)) == _graph->id(v)) continue;
-        int id = _graph->id(_graph->target(f));
-        if ((!_dijkstra.processed(_graph->target(f))) || (_dijkstra.currentDist(_graph->target(f)) > (*_cost)[e] + (*_cost)[f])) {
-          Arc t = INVALID;
-          for (OutArcIt r(*_graph, w); r != INVALID; ++r) {
-            if (_graph->id(_graph->target(r)) == id) {
-              t = r;
-              break;
-            }
-          }
-          if (t == INVALID) {
-            Arc sa = _graph->addArc(_graph->source(e),_graph->target(f));
-            (*_cost)[sa] = (*_cost)[e] + (*_cost)[f];
-            (*_pack)[sa] = make_pair(e,f);
-          }
-          else if ((*_cost)[t] > (*_cost)[e] + (*_cost)[f]) {
-            (*_cost)[t] = (*_cost)[e] + (*_cost)[f];
-            (*_pack)[t] = make_pair(e,f);
-          }
-        }
-      }
-      _dijkstra.clear();
+      _cache.touch(_graph->source(e));
     }
+    if (_cgraph != NULL) _cgraph->erase(v);
   }
 
-  ///Creates the search graphs and adds their pointers to the CHData struct given in the contructor.
-  void createSearchGraphs() {
-    Graph::NodeMap<bool> nf1(*_graph,true);
-    Graph::NodeMap<bool> nf2(*_graph,true);
-    Graph::ArcMap<bool> af1(*_graph,false);
-    Graph::ArcMap<bool> af2(*_graph,false);
-    // forward edges
-    MySubDigraph sg1(*_graph,nf1,af1);
-    // backward edges
-    MySubDigraph sg2(*_graph,nf2,af2);
-
-    vector<Arc> to_reverse;
-    vector<Arc> not_to_reverse;
+  ///Sets the limits of the witness searches of the priority and of the contraction
+  ///depending on the average degree of the remaining graph.
+  ///Without a policy the simulated contractions are limited to 5 hops, the real ones are not limited.
+  ///\return The limits of the contraction
+  WitnessLimit updateWitnessLimits() {
+    WitnessLimit limit = _policy.limit(_remaining == 0 ? 0 : double(_live_arcs) / _remaining);
+    _priority.setWitnessLimits(_policy.empty() ? WitnessLimit(5) : limit, limit);
+    _dijkstra.setLimit(limit);
+    if (_cgdijkstra != NULL) _cgdijkstra->setLimit(limit);
+    return limit;
+  }
 
-    for (Graph::ArcIt e(*_graph); e != INVALID; ++e) {
-      Node u = _graph->source(e);
-      Node v = _graph->target(e);
-      if (_searchorder[u] < _searchorder[v]) not_to_reverse.push_back(e);
-      else if (_searchorder[u] > _searchorder[v]) to_reverse.push_back(e);
+  ///Sets the search order of a contracted node.
+  ///\param v The node
+  ///\param order The position of v in the contraction order
+  void setContracted(Node v, int order) {
+    for (OutArcIt e(*_graph, v); e != INVALID; ++e) {
+      if (!_finalized[_graph->target(e)] && _graph->target(e) != v) --_live_arcs;
+    }
+    for (InArcIt e(*_graph, v); e != INVALID; ++e) {
+      if (!_finalized[_graph->source(e)] && _graph->source(e) != v) --_live_arcs;
+    }
+    --_remaining;
+    // the arcs to the higher nodes don't change any more
+    _forward_buffer.addNode();
+    for (OutArcIt e(*_graph, v); e != INVALID; ++e) {
+      Node w = _graph->target(e);
+      if (!_finalized[w] && w != v) _forward_buffer.addArc(_graph->id(w), (*_cost)[e], _code[e]);
+    }
+    // the backward graph contains the arcs from the higher nodes reversed
+    _backward_buffer.addNode();
+    for (InArcIt e(*_graph, v); e != INVALID; ++e) {
+      Node w = _graph->source(e);
+      if (!_finalized[w] && w != v) _backward_buffer.addArc(_graph->id(w), (*_cost)[e], _code[e]);
+    }
+    _searchorder[v] = order;
+    (*_order_vector)[order] = _graph->id(v);
+    _finalized[v] = true;
+  }
+
+  ///Erases the shortcuts of a finalized node from the graph, the search graph buffers keep them.
+  ///The priority must have seen the neighbours of the node, so it is called after finalizing it.
+  ///\param v The node
+  void eraseShortcuts(Node v) {
+    vector<Arc> arcs;
+    for (OutArcIt e(*_graph, v); e != INVALID; ++e) {
+      if (_added[e]) arcs.push_back(e);
+    }
+    for (InArcIt e(*_graph, v); e != INVALID; ++e) {
+      if (_added[e] && _graph->source(e) != v) arcs.push_back(e);
     }
+    for (unsigned int i = 0; i < arcs.size(); ++i) {
+      _graph->erase(arcs[i]);
+    }
+  }
 
-    for (unsigned int i = 0; i < to_reverse.size(); ++i) {
-      _graph->reverseArc(to_reverse[i]);
-      af2[to_reverse[i]] = true;
+  ///Contracts the nodes in rounds of independent node sets.
+  ///The witness searches of a round run in parallel, each thread has its own dijkstra.
+  ///The shortcuts are added in the order of the selected nodes, so the result doesn't depend on the thread count.
+  ///\param g The graph the searches run on
+  ///\param cost The arc costs
+  ///\param dijkstra The dijkstra of the first thread
+  template <typename G, typename D>
+  void runRounds(G& g, typename G::template ArcMap<int>& cost, D& dijkstra) {
+    int threads = maxThreads();
+    vector<D*> dijkstras(threads);
+    dijkstras[0] = &dijkstra;
+    for (int t = 1; t < threads; ++t) {
+      dijkstras[t] = new D(g, cost);
+    }
+    int order = 0;
+    vector<Node> nodes;
+    _priority.nextNodes(nodes);
+    while (!nodes.empty()) {
+      int k = nodes.size();
+      // the nodes of the round are excluded from every witness search
+      for (int t = 0; t < threads; ++t) {
+        for (int i = 0; i < k; ++i) {
+          dijkstras[t]->addContractedNode(nodes[i]);
+        }
+      }
+      WitnessLimit limit = updateWitnessLimits();
+      for (int t = 1; t < threads; ++t) {
+        dijkstras[t]->setLimit(limit);
+      }
+      vector<vector<Shortcut> > shortcuts(k);
+#pragma omp parallel for schedule(dynamic)
+      for (int i = 0; i < k; ++i) {
+        findShortcuts(g, cost, *dijkstras[threadNum()], nodes[i], shortcuts[i]);
+      }
+      for (int i = 0; i < k; ++i) {
+        addShortcuts(shortcuts[i]);
+        setContracted(nodes[i], order);
+        if (_cgraph != NULL) _cgraph->erase(nodes[i]);
+        order++;
+      }
+      updateWitnessLimits();
+      _priority.finalizeNodes(nodes);
+      for (int i = 0; i < k; ++i) {
+        eraseShortcuts(nodes[i]);
+      }
+      nodes.clear();
+      _priority.nextNodes(nodes);
+    }
+    for (int t = 1; t < threads; ++t) {
+      delete dijkstras[t];
     }
+  }
 
-    for (unsigned int i = 0; i < not_to_reverse.size(); ++i) {
-      af1[not_to_reverse[i]] = true;
+  ///Creates the search graphs and adds their pointers to the CHData struct given in the contructor.
+  ///The nodes of the search graphs are numbered in descending contraction order, so the high nodes
+  ///reached by most searches are next to each other in the memory. The arcs were collected when
+  ///their lower end was contracted.
+  void createSearchGraphs() {
+    vector<int> ref(_graph->maxNodeId() + 1, -1);
+    for (Graph::NodeIt v(*_graph); v != INVALID; ++v) {
+      ref[_graph->id(v)] = _data->nodes - 1 - _searchorder[v];
     }
 
     _data->forward_graph = new StaticDigraph();
     _data->forward_cost = new StaticDigraph::ArcMap<int>(*(_data->forward_graph));
     _data->forward_nodeRef = new Graph::NodeMap<StaticDigraph::Node>(*_graph);
-    _data->forward_backArcRef = new StaticDigraph::ArcMap<Arc>(*(_data->forward_graph));
+    _data->forward_backArcRef = new StaticDigraph::ArcMap<int>(*(_data->forward_graph));
 
     _data->backward_graph = new StaticDigraph();
     _data->backward_cost = new StaticDigraph::ArcMap<int>(*(_data->backward_graph));
     _data->backward_nodeRef = new Graph::NodeMap<StaticDigraph::Node>(*_graph);
-    _data->backward_backArcRef = new StaticDigraph::ArcMap<Arc>(*(_data->backward_graph));
+    _data->backward_backArcRef = new StaticDigraph::ArcMap<int>(*(_data->backward_graph));
 
-    DigraphCopy<MySubDigraph, StaticDigraph> cg1(sg1, *(_data->forward_graph));
-    cg1.nodeRef(*(_data->forward_nodeRef));
-    cg1.arcMap(*_cost, *(_data->forward_cost));
-    cg1.arcCrossRef(*(_data->forward_backArcRef));
-    cg1.run();
+    _forward_buffer.build(_data->nodes, ref, *(_data->forward_graph), *(_data->forward_cost),
+      *(_data->forward_backArcRef));
+    _backward_buffer.build(_data->nodes, ref, *(_data->backward_graph), *(_data->backward_cost),
+      *(_data->backward_backArcRef));
 
-    DigraphCopy<MySubDigraph, StaticDigraph> cg2(sg2, *(_data->backward_graph));
-    cg2.nodeRef(*(_data->backward_nodeRef));
-    cg2.arcMap(*_cost, *(_data->backward_cost));
-    cg2.arcCrossRef(*(_data->backward_backArcRef));
-    cg2.run();
-
-    // restore original edge directions
-    for (unsigned int i = 0; i < to_reverse.size(); ++i) {
-      _graph->reverseArc(to_reverse[i]);
+    for (Graph::NodeIt v(*_graph); v != INVALID; ++v) {
+      StaticDigraph::Node w = StaticDigraph::nodeFromId(ref[_graph->id(v)]);
+      (*(_data->forward_nodeRef))[v] = w;
+      (*(_data->backward_nodeRef))[v] = w;
     }
   }
 
@@ -183,31 +386,88 @@ public:
   ///Initializes the preprocessing algorithm.
   ///\param chdata The CHData struct containing the graph and the arc costs
   Preprocess(CHData& chdata):
-  _data(&chdata), _finalized(*_data->graph, false), _priority(*_data), _searchorder(*_data->graph), _dijkstra(*_data->graph, *_data->cost) {
+  _data(&chdata), _finalized(*_data->graph, false), _priority(*_data), _searchorder(*_data->graph),
+  _code(*_data->graph), _added(*_data->graph, false), _hops(*_data->graph, 1),
+  _dijkstra(*_data->graph, *_data->cost), _cache(*_data->graph) {
     _graph = _data->graph;
     _cost = _data->cost;
     _order_vector = NULL;
+    _cgraph = NULL;
+    _cgdijkstra = NULL;
+    _parallel = false;
+    _use_cgraph = false;
 
-    _pack = new Graph::ArcMap<pair<Arc,Arc> >(*_graph, make_pair(INVALID, INVALID));
+    _pack = new vector<PackedArc>();
     _data->pack = _pack;
+    _data->hops = &_hops;
+    for (Graph::ArcIt e(*_graph); e != INVALID; ++e) {
+      _code[e] = _graph->id(e);
+    }
+  }
+
+  ~Preprocess() {
+    _data->hops = NULL;
+    delete _cgdijkstra;
+    delete _cgraph;
+  }
+
+  ///Use a ContractionGraph as the working graph of the witness searches instead of the ListDigraph.
+  ///The shortcuts are still added to the ListDigraph too.
+  ///\param use Whether the contraction graph is used
+  void setContractionGraph(bool use) {
+    _use_cgraph = use;
+  }
+
+  ///Sets the policy choosing the limits of the witness searches of the contraction and of the priority.
+  ///\param policy The policy
+  void setWitnessPolicy(const WitnessPolicy& policy) {
+    _policy = policy;
+  }
+
+  ///Contract independent node sets in parallel instead of one node at a time.
+  ///\param parallel Whether the parallel contraction is used
+  void setParallel(bool parallel) {
+    _parallel = parallel;
   }
 
   ///Run the preprocessing algorithm.
   void run() {
     _order_vector = new vector<int>(_data->nodes);
-    int order = 0;
+    _remaining = _data->nodes;
+    _live_arcs = 0;
+    for (Graph::ArcIt e(*_graph); e != INVALID; ++e) {
+      if (_graph->source(e) != _graph->target(e)) ++_live_arcs;
+    }
+    if (_use_cgraph) {
+      _cgraph = new ContractionGraph(*_graph, *_cost);
+      _cgdijkstra = new CGDijkstra(*_cgraph, _cgraph->costMap());
+    }
+    updateWitnessLimits();
     _priority.init();
-    Node v = _priority.nextNode();
-    while (v != INVALID) {
-      _searchorder[v] = order;
-      (*_order_vector)[order] = _graph->id(v);
-      contract(v);
-      _priority.finalize(v);
-      _finalized[v] = true;
-      order++;
+    if (_parallel) {
+      // the witness searches of the simulations don't skip the other nodes of a round
+      _priority.setCache(NULL);
+      if (_cgraph != NULL) runRounds(*_cgraph, _cgraph->costMap(), *_cgdijkstra);
+      else runRounds(*_graph, *_cost, _dijkstra);
+    } else {
+      _priority.setCache(&_cache);
+      int order = 0;
+      Node v = _priority.nextNode();
+      while (v != INVALID) {
+        contract(v);
+        setContracted(v, order);
+        updateWitnessLimits();
+        _priority.finalize(v);
+        eraseShortcuts(v);
+        order++;
 
-      v = _priority.nextNode();
+        v = _priority.nextNode();
+      }
     }
+    delete _cgdijkstra;
+    delete _cgraph;
+    _cgdijkstra = NULL;
+    _cgraph = NULL;
     createSearchGraphs();
     if (_data->local_order) _data->order = _order_vector;
     else delete _order_vector;
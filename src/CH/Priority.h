@@ -19,7 +19,13 @@
 #ifndef CH_PRIORITY_H
 #define CH_PRIORITY_H
 
+#include <vector>
 #include <lemon/list_graph.h>
+#include "Utils/ShortcutCache.h"
+#include "Utils/WitnessPolicy.h"
+#include "Utils/HeapPolicy.h"
+
+using std::vector;
 
 ///The interface used to calculate the priority of the nodes.
 ///Every class that calculates the node orders should be subclasses of this class.
@@ -30,6 +36,9 @@ class Priority {
 
 public:
 
+  ///The heap policy of the witness searches of the preprocessing.
+  typedef BinHeapPolicy HeapPolicy;
+
   virtual ~Priority() {}
 
   ///Creates the initial order of the nodes.
@@ -42,6 +51,33 @@ public:
   ///Finalize the given node.
   ///\param v The node
   virtual void finalize(Node v) {}
+
+  ///Sets the cache where the shortcuts found while calculating the priority of the next node should be stored.
+  ///By default nothing is stored.
+  ///\param cache The cache
+  virtual void setCache(ShortcutCache* cache) {}
+
+  ///Sets the limits of the witness searches of the simulated contractions.
+  ///\param simulation The limits used while calculating the priorities
+  ///\param contraction The limits used when the shortcuts are stored for the contraction
+  virtual void setWitnessLimits(const WitnessLimit& simulation, const WitnessLimit& contraction) {}
+
+  ///Selects the nodes which should be contracted in the next round of the parallel preprocessing.
+  ///The selected nodes must not be within two hops of each other.
+  ///By default only the next node is selected.
+  ///\param nodes The vector the selected nodes are added to
+  virtual void nextNodes(vector<Node>& nodes) {
+    Node v = nextNode();
+    if (v != lemon::INVALID) nodes.push_back(v);
+  }
+
+  ///Finalize the nodes contracted in the same round.
+  ///\param nodes The nodes
+  virtual void finalizeNodes(const vector<Node>& nodes) {
+    for (unsigned int i = 0; i < nodes.size(); ++i) {
+      finalize(nodes[i]);
+    }
+  }
 };
 
 #endif
@@ -0,0 +1,125 @@
+/* -*- mode: C++; indent-tabs-mode: nil; -*-
+ *
+ * This file is a part of LEMON, a generic C++ optimization library.
+ *
+ * Copyright (C) 2003-2013
+ * Egervary Jeno Kombinatorikus Optimalizalasi Kutatocsoport
+ * (Egervary Research Group on Combinatorial Optimization, EGRES).
+ *
+ * Permission to use, modify and distribute this software is granted
+ * provided that this copyright notice appears in all copies. For
+ * precise terms see the accompanying LICENSE file.
+ *
+ * This software is provided "AS IS" with no warranty of any kind,
+ * express or implied, and with no claim as to its suitability for any
+ * purpose.
+ *
+ */
+#ifndef QUERYCONTEXT_H
+#define QUERYCONTEXT_H
+
+#include <vector>
+#include <lemon/list_graph.h>
+#include <lemon/static_graph.h>
+#include "CHData.h"
+#include "CHSearch.h"
+#include "PathReconstruct.h"
+
+using std::vector;
+using lemon::ListDigraph;
+using lemon::StaticDigraph;
+
+///The state of the searches of one thread on a preprocessed graph.
+///
+///The hierarchy in the CHData is only read, every context has its own heaps, distance and pred maps.
+///So more threads can search on the same CHData at the same time, if each of them uses its own context.
+///A context created from a QueryGraph only uses the query graph, the CHData and the original graph
+///may already be deleted. The nodes and arcs of the original graph are still given by their ids.
+///\tparam HP The heap policy of the searches
+template <typename HP = BinHeapPolicy>
+class QueryContext {
+
+  typedef ListDigraph::Node Node;
+  typedef ListDigraph::NodeMap<StaticDigraph::Node> RefMap;
+
+private:
+
+  CHSearch<HP> _search;
+  PathReconstruct<HP> _pathrec;
+  const RefMap *_forward_noderef;
+  const RefMap *_backward_noderef;
+  ///The query graph of a self-contained context, NULL if the CHData is used
+  const QueryGraph *_query_graph;
+
+  ///\param v A node of the original graph
+  ///\return The node of the forward search graph
+  StaticDigraph::Node forwardNode(Node v) const {
+    return _query_graph != NULL ? _query_graph->nodeRef(v) : (*_forward_noderef)[v];
+  }
+
+  ///\param v A node of the original graph
+  ///\return The node of the backward search graph
+  StaticDigraph::Node backwardNode(Node v) const {
+    return _query_graph != NULL ? _query_graph->nodeRef(v) : (*_backward_noderef)[v];
+  }
+
+public:
+
+  ///Creates the search state.
+  ///\param chdata The CHData containing a preprocessed graph
+  ///\param query_graph The merged search graph of chdata, NULL to search on the static graphs
+  QueryContext(const CHData& chdata, const QueryGraph* query_graph = NULL):
+    _search(chdata, query_graph), _pathrec(chdata, _search) {
+    _forward_noderef = chdata.forward_nodeRef;
+    _backward_noderef = chdata.backward_nodeRef;
+    _query_graph = NULL;
+  }
+
+  ///Creates a self-contained search state.
+  ///\param query_graph The query graph of a preprocessed graph
+  QueryContext(const QueryGraph& query_graph):
+    _search(query_graph), _pathrec(_search) {
+    _forward_noderef = NULL;
+    _backward_noderef = NULL;
+    _query_graph = &query_graph;
+  }
+
+  ///Use stall-on-demand in the searches.
+  ///\param stall Whether stall-on-demand is used
+  void setStallOnDemand(bool stall) {
+    _search.setStallOnDemand(stall);
+  }
+
+  ///Runs the search from Node s to Node t.
+  ///\param s The source node in the original graph
+  ///\param t The target node in the original graph
+  void run(Node s, Node t) {
+    StaticDigraph::Node fs = forwardNode(s);
+    StaticDigraph::Node bt = backwardNode(t);
+    _search.run(fs, bt);
+  }
+
+  ///Runs the search from a new source node using the previous search results.
+  ///\param s The new source node in the original graph
+  void run_newSource(Node s) {
+    StaticDigraph::Node fs = forwardNode(s);
+    _search.run_newSource(fs);
+  }
+
+  ///\return The distance between the previous search's source and target
+  int dist() const {
+    return _search.dist();
+  }
+
+  ///\return The path between the previous search's source and target
+  vector<ListDigraph::Arc> getPath() const {
+    return _pathrec.getPath();
+  }
+
+  ///Clears the previous results.
+  void clear() {
+    _search.clear();
+  }
+};
+
+#endif
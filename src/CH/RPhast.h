@@ -0,0 +1,182 @@
+/* -*- mode: C++; indent-tabs-mode: nil; -*-
+ *
+ * This file is a part of LEMON, a generic C++ optimization library.
+ *
+ * Copyright (C) 2003-2013
+ * Egervary Jeno Kombinatorikus Optimalizalasi Kutatocsoport
+ * (Egervary Research Group on Combinatorial Optimization, EGRES).
+ *
+ * Permission to use, modify and distribute this software is granted
+ * provided that this copyright notice appears in all copies. For
+ * precise terms see the accompanying LICENSE file.
+ *
+ * This software is provided "AS IS" with no warranty of any kind,
+ * express or implied, and with no claim as to its suitability for any
+ * purpose.
+ *
+ */
+#ifndef RPHAST_H
+#define RPHAST_H
+
+#include <vector>
+#include <algorithm>
+#include <climits>
+#include <lemon/list_graph.h>
+#include <lemon/static_graph.h>
+#include "CHData.h"
+#include "Utils/SearchDijkstra.h"
+#include "Utils/HeapPolicy.h"
+
+using std::vector;
+using std::pair;
+using std::make_pair;
+using std::sort;
+using lemon::ListDigraph;
+using lemon::StaticDigraph;
+using lemon::INVALID;
+
+///Calculates the distances from a source to a fixed set of targets (RPHAST).
+///
+///Selecting the targets collects the nodes reachable from them in the backward graph, these are the
+///only nodes whose downward arcs can lead to a target. The selected nodes are renumbered in
+///descending contraction order with their arcs in a compact array. A query runs the upward search
+///from the source, then sweeps only the selected nodes like PHAST.
+///\tparam HP The heap policy of the upward search
+template <typename HP = BinHeapPolicy>
+class RPhast {
+
+  typedef StaticDigraph Graph;
+  typedef Graph::Node Node;
+  typedef Graph::OutArcIt OutArcIt;
+  typedef Graph::ArcMap<int> Cost;
+  typedef SearchDijkstra<typename SearchHeap<Graph, HP>::type> Dijkstra;
+
+private:
+
+  Graph *_backward_graph;
+  Cost *_backward_cost;
+  ListDigraph::NodeMap<StaticDigraph::Node> *_forward_noderef;
+  Dijkstra _dijkstra;
+
+  ///The contraction order of the nodes, indexed by the node ids of the search graphs
+  vector<int> _rank;
+  ///The index of the selected nodes in the sweep, -1 for the other nodes
+  vector<int> _index;
+  ///The selected nodes in descending contraction order
+  vector<int> _nodes;
+  ///The first arc of every selected node
+  vector<int> _arc_begin;
+  ///The index of the higher node of the arcs
+  vector<int> _arc_head;
+  vector<int> _arc_cost;
+  ///The index of the targets in the sweep
+  vector<int> _targets;
+  ///The distances of the selected nodes
+  vector<int> _dist;
+
+public:
+
+  ///Initializes the algorithm.
+  ///\param chdata The CHData containing a preprocessed graph and its contraction order
+  RPhast(const CHData& chdata):
+    _dijkstra(*chdata.forward_graph, *chdata.forward_cost) {
+    _backward_graph = chdata.backward_graph;
+    _backward_cost = chdata.backward_cost;
+    _forward_noderef = chdata.forward_nodeRef;
+    const vector<int>& order = *chdata.order;
+    _rank.resize(_backward_graph->nodeNum());
+    for (unsigned int i = 0; i < order.size(); ++i) {
+      _rank[Graph::id((*_forward_noderef)[chdata.graph->nodeFromId(order[i])])] = i;
+    }
+    _index.assign(_backward_graph->nodeNum(), -1);
+  }
+
+  ///Selects the targets of the next queries.
+  ///\param targets The targets in the original graph
+  void selectTargets(const vector<ListDigraph::Node>& targets) {
+    for (unsigned int i = 0; i < _nodes.size(); ++i) {
+      _index[_nodes[i]] = -1;
+    }
+    _nodes.clear();
+    for (unsigned int i = 0; i < targets.size(); ++i) {
+      int v = Graph::id((*_forward_noderef)[targets[i]]);
+      if (_index[v] == -1) {
+        _index[v] = 0;
+        _nodes.push_back(v);
+      }
+    }
+    for (unsigned int i = 0; i < _nodes.size(); ++i) {
+      for (OutArcIt e(*_backward_graph, _backward_graph->nodeFromId(_nodes[i])); e != INVALID; ++e) {
+        int u = Graph::id(_backward_graph->target(e));
+        if (_index[u] == -1) {
+          _index[u] = 0;
+          _nodes.push_back(u);
+        }
+      }
+    }
+    vector<pair<int, int> > ranked;
+    for (unsigned int i = 0; i < _nodes.size(); ++i) {
+      ranked.push_back(make_pair(-_rank[_nodes[i]], _nodes[i]));
+    }
+    sort(ranked.begin(), ranked.end());
+    for (unsigned int i = 0; i < ranked.size(); ++i) {
+      _nodes[i] = ranked[i].second;
+      _index[_nodes[i]] = i;
+    }
+    _arc_begin.assign(1, 0);
+    _arc_head.clear();
+    _arc_cost.clear();
+    for (unsigned int i = 0; i < _nodes.size(); ++i) {
+      for (OutArcIt e(*_backward_graph, _backward_graph->nodeFromId(_nodes[i])); e != INVALID; ++e) {
+        _arc_head.push_back(_index[Graph::id(_backward_graph->target(e))]);
+        _arc_cost.push_back((*_backward_cost)[e]);
+      }
+      _arc_begin.push_back(_arc_head.size());
+    }
+    _targets.clear();
+    for (unsigned int i = 0; i < targets.size(); ++i) {
+      _targets.push_back(_index[Graph::id((*_forward_noderef)[targets[i]])]);
+    }
+    _dist.resize(_nodes.size());
+  }
+
+  ///Calculates the distances from the source to the selected targets.
+  ///\param s The source in the original graph
+  void run(ListDigraph::Node s) {
+    _dist.assign(_nodes.size(), INT_MAX);
+    _dijkstra.addSource((*_forward_noderef)[s]);
+    while (_dijkstra.nextNode() != INVALID) {
+      Node v = _dijkstra.processNextNode();
+      int i = _index[Graph::id(v)];
+      if (i != -1) _dist[i] = _dijkstra.currentDist(v);
+    }
+    _dijkstra.clear();
+    for (unsigned int i = 0; i < _nodes.size(); ++i) {
+      int d = _dist[i];
+      for (int a = _arc_begin[i]; a < _arc_begin[i + 1]; ++a) {
+        int du = _dist[_arc_head[a]];
+        if (du != INT_MAX && du + _arc_cost[a] < d) d = du + _arc_cost[a];
+      }
+      _dist[i] = d;
+    }
+  }
+
+  ///\return The number of nodes swept by a query
+  int sweepSize() const {
+    return _nodes.size();
+  }
+
+  ///\return The number of the selected targets
+  int targetNum() const {
+    return _targets.size();
+  }
+
+  ///\param i The index of the target in the selected targets
+  ///\return The distance of the target from the source of the last query, -1 if it can't be reached
+  int dist(int i) const {
+    int d = _dist[_targets[i]];
+    return d == INT_MAX ? -1 : d;
+  }
+};
+
+#endif
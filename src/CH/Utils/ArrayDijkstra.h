@@ -0,0 +1,144 @@
+/* -*- mode: C++; indent-tabs-mode: nil; -*-
+ *
+ * This file is a part of LEMON, a generic C++ optimization library.
+ *
+ * Copyright (C) 2003-2013
+ * Egervary Jeno Kombinatorikus Optimalizalasi Kutatocsoport
+ * (Egervary Research Group on Combinatorial Optimization, EGRES).
+ *
+ * Permission to use, modify and distribute this software is granted
+ * provided that this copyright notice appears in all copies. For
+ * precise terms see the accompanying LICENSE file.
+ *
+ * This software is provided "AS IS" with no warranty of any kind,
+ * express or implied, and with no claim as to its suitability for any
+ * purpose.
+ *
+ */
+#ifndef ArrayDijkstra_H
+#define ArrayDijkstra_H
+
+#include <vector>
+#include <lemon/bin_heap.h>
+#include <lemon/maps.h>
+
+using std::vector;
+using lemon::BinHeap;
+using lemon::RangeMap;
+
+///Dijkstra algorithm on a graph given by arrays, used for searching in memory mapped hierarchies.
+///
+///The arcs of node v are begin[v] .. begin[v + 1] - 1, with the target and the cost of arc a in head[a] and cost[a].
+///The nodes are ints, the arrays are only read.
+class ArrayDijkstra {
+
+  typedef RangeMap<int> StateMap;
+  typedef BinHeap<int, StateMap> Heap;
+
+private:
+
+  const int *_begin;
+  const int *_head;
+  const int *_cost;
+  StateMap _state;
+  Heap _heap;
+  vector<int> _distance;
+  vector<int> _pred;
+  vector<int> _pred_node;
+  ///The reached nodes to reset
+  vector<int> _reset;
+
+public:
+
+  ///Initializes the algorithm.
+  ///\param nodes The number of nodes
+  ///\param begin The first arc of every node and the end of the arcs
+  ///\param head The target of the arcs
+  ///\param cost The cost of the arcs
+  ArrayDijkstra(int nodes, const int* begin, const int* head, const int* cost):
+    _begin(begin), _head(head), _cost(cost), _state(nodes, -1), _heap(_state),
+    _distance(nodes), _pred(nodes), _pred_node(nodes) {
+  }
+
+  ///Add a new source.
+  ///\param s The source node
+  void addSource(int s) {
+    if (_heap.state(s) == -1) _reset.push_back(s);
+    _heap.push(s, 0);
+    _pred[s] = -1;
+  }
+
+  ///\return True if there are no more nodes to process
+  bool empty() const {
+    return _heap.empty();
+  }
+
+  ///\return The distance of the next node to be processed
+  int nextDist() const {
+    return _heap.prio();
+  }
+
+  ///\param v The node
+  ///\return Whether v is reached.
+  bool reached(int v) const {
+    return _heap.state(v) != -1;
+  }
+
+  ///\param v A reached node
+  ///\return The current distance of v from the source.
+  int currentDist(int v) const {
+    return _heap.state(v) == -2 ? _distance[v] : _heap[v];
+  }
+
+  ///\param v A reached node
+  ///\return The arc used to reach v, -1 for the source
+  int predArc(int v) const {
+    return _pred[v];
+  }
+
+  ///\param v A reached node
+  ///\return The node before v on the path from the source
+  int predNode(int v) const {
+    return _pred_node[v];
+  }
+
+  ///Process the next node.
+  int processNextNode() {
+    int v = _heap.top();
+    int d = _heap.prio();
+    _heap.pop();
+    _distance[v] = d;
+    for (int a = _begin[v]; a < _begin[v + 1]; ++a) {
+      int w = _head[a];
+      switch (_heap.state(w)) {
+      case -1:
+        _heap.push(w, d + _cost[a]);
+        _pred[w] = a;
+        _pred_node[w] = v;
+        _reset.push_back(w);
+        break;
+      case 0:
+        if (d + _cost[a] < _heap[w]) {
+          _heap.decrease(w, d + _cost[a]);
+          _pred[w] = a;
+          _pred_node[w] = v;
+        }
+        break;
+      default:
+        break;
+      }
+    }
+    return v;
+  }
+
+  ///Reset every calculated value.
+  void clear() {
+    _heap.clear();
+    for (unsigned int i = 0; i < _reset.size(); ++i) {
+      _state.set(_reset[i], -1);
+    }
+    _reset.clear();
+  }
+};
+
+#endif
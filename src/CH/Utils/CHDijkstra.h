@@ -21,13 +21,21 @@
 
 #include <stack>
 #include <lemon/bin_heap.h>
+#include "VersionedNodeMap.h"
 
 using std::stack;
 using lemon::INVALID;
 using lemon::BinHeap;
 
 ///Template Dijkstra algorithm with support for resetting values instead of using new Map instances for greater speed.
-template <typename Graph>
+///\tparam Graph The type of the graph
+///
+///The reached nodes are reset one by one when the search is cleared. If the item-int map of the heap
+///is a VersionedNodeMap, clearing only starts a new round of the map. The other maps of the derived
+///classes are initialized when a node is reached, so they don't have to be reset.
+///\tparam H The type of the heap, a LEMON heap or a FourAryHeap using an int NodeMap
+///or a VersionedNodeMap of the graph as item-int map
+template <typename Graph, typename H = BinHeap<int, typename Graph::template NodeMap<int> > >
 class CHDijkstra {
 
 protected:
@@ -37,17 +45,24 @@ protected:
   typedef typename Graph::template ArcMap<int> ArcMap;
   typedef typename Graph::template NodeMap<int> NodeMap;
   typedef typename Graph::OutArcIt OutArcIt;
-  typedef BinHeap<int,NodeMap> Heap;
+  typedef H Heap;
+  typedef typename Heap::ItemIntMap StateMap;
+  typedef SearchState<StateMap> State;
   ///The stack containing nodes to reset
   typedef stack<Node> ResetStack;
 
   Graph *_graph;
   ArcMap *_cost;
-  NodeMap *_state;
+  StateMap *_state;
   Heap *_heap;
   NodeMap *_distance;
   ResetStack *_reset_stack;
 
+  ///Stores a reached node for resetting it, if the states are not versioned.
+  void touch(Node v) {
+    if (!State::versioned) _reset_stack->push(v);
+  }
+
 public:
 
   ///Initializes the algorithm.
@@ -55,7 +70,7 @@ public:
   ///\param cost The arcMap with the arc costs.
   CHDijkstra(Graph& graph, ArcMap& cost):
   _graph(&graph), _cost(&cost) {
-    _state = new NodeMap(*_graph, -1);
+    _state = new StateMap(*_graph, -1);
     _heap = new Heap(*_state);
     _distance = new NodeMap(*_graph);
     _reset_stack = new ResetStack();
@@ -74,11 +89,11 @@ public:
   void addSource(Node s, int d=0) {
     if(_heap->state(s) != 0) {
       _heap->push(s, d);
-      _reset_stack->push(s);
+      touch(s);
     }
     else if((*_heap)[s] < d) {
       _heap->push(s, d);
-      _reset_stack->push(s);
+      touch(s);
     }
   }
 
@@ -116,7 +131,7 @@ public:
       switch(_heap->state(w)) {
       case -1:
         _heap->push(w, d + (*_cost)[e]);
-        _reset_stack->push(w);
+        touch(w);
         break;
       case 0:
         if (d + (*_cost)[e] < (*_heap)[w]) {
@@ -133,6 +148,10 @@ public:
   ///Reset every calculated value.
   void clear() {
     _heap->clear();
+    if (State::versioned) {
+      State::nextRound(*_state);
+      return;
+    }
     while (!_reset_stack->empty()) {
       Node v = _reset_stack->top();
       clearNode(v);
@@ -142,14 +161,14 @@ public:
 
   ///Resets the calculated values of a node.
   ///\param v The node
-  void virtual clearNode(Node v) {
-    (*_state)[v] = -1;
+  void clearNode(Node v) {
+    _state->set(v, -1);
   }
 
   ///Removes a node from further searches
   ///\param v The node
   void addContractedNode(Node v) {
-    (*_state)[v] = -2;
+    State::setBase(*_state, v, -2);
   }
 };
 
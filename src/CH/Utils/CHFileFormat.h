@@ -0,0 +1,113 @@
+/* -*- mode: C++; indent-tabs-mode: nil; -*-
+ *
+ * This file is a part of LEMON, a generic C++ optimization library.
+ *
+ * Copyright (C) 2003-2013
+ * Egervary Jeno Kombinatorikus Optimalizalasi Kutatocsoport
+ * (Egervary Research Group on Combinatorial Optimization, EGRES).
+ *
+ * Permission to use, modify and distribute this software is granted
+ * provided that this copyright notice appears in all copies. For
+ * precise terms see the accompanying LICENSE file.
+ *
+ * This software is provided "AS IS" with no warranty of any kind,
+ * express or implied, and with no claim as to its suitability for any
+ * purpose.
+ *
+ */
+#ifndef CHFileFormat_H
+#define CHFileFormat_H
+
+#include <cstring>
+
+///The layout of a binary CH file.
+///
+///The file starts with the header, followed by the int arrays listed in Section. Every array starts
+///at an offset divisible by 8, so the arrays can be used directly from a memory mapped file.
+///The numbers are stored in the byte order of the writing machine, byte_order tells if it differs.
+struct CHFileHeader {
+
+  ///The arrays stored in the file
+  enum Section {
+    ///The search graph node of every original node id, -1 for unused ids (max_node_id + 1)
+    NODE_REF,
+    ///The original node id of every search graph node (nodes)
+    NODE_ID,
+    ///The original node ids in the order of contraction (nodes)
+    ORDER,
+    ///The first arc of every node in the forward graph (nodes + 1)
+    FORWARD_BEGIN,
+    ///The target of the forward arcs (forward_arcs)
+    FORWARD_HEAD,
+    ///The cost of the forward arcs (forward_arcs)
+    FORWARD_COST,
+    ///The arc code of the forward arcs: the original arc id, or -1 - i for the i-th shortcut (forward_arcs)
+    FORWARD_ARC,
+    ///The first arc of every node in the backward graph (nodes + 1)
+    BACKWARD_BEGIN,
+    ///The target of the backward arcs (backward_arcs)
+    BACKWARD_HEAD,
+    ///The cost of the backward arcs (backward_arcs)
+    BACKWARD_COST,
+    ///The arc code of the backward arcs (backward_arcs)
+    BACKWARD_ARC,
+    ///The arc code of the first bypassed arc of every shortcut (shortcuts)
+    PACK_FIRST,
+    ///The arc code of the second bypassed arc of every shortcut (shortcuts)
+    PACK_SECOND,
+    SECTIONS
+  };
+
+  static const int FILE_VERSION = 2;
+  static const int ORDER_MARK = 0x01020304;
+
+  char magic[8];
+  int version;
+  int byte_order;
+  int nodes;
+  int max_node_id;
+  int forward_arcs;
+  int backward_arcs;
+  int shortcuts;
+  int reserved;
+  ///The offset of the arrays in bytes
+  long long offset[SECTIONS];
+  ///The size of the whole file in bytes
+  long long size;
+
+  CHFileHeader() {
+    memset(this, 0, sizeof(CHFileHeader));
+    memcpy(magic, "CHLEMON", 8);
+    version = FILE_VERSION;
+    byte_order = ORDER_MARK;
+  }
+
+  ///\return The number of ints in a section
+  long long length(int section) const {
+    switch (section) {
+      case NODE_REF: return max_node_id + 1;
+      case NODE_ID: case ORDER: return nodes;
+      case FORWARD_BEGIN: case BACKWARD_BEGIN: return nodes + 1;
+      case FORWARD_HEAD: case FORWARD_COST: case FORWARD_ARC: return forward_arcs;
+      case BACKWARD_HEAD: case BACKWARD_COST: case BACKWARD_ARC: return backward_arcs;
+      default: return shortcuts;
+    }
+  }
+
+  ///Calculates the offsets and the file size from the counts.
+  void layout() {
+    long long pos = (sizeof(CHFileHeader) + 7) & ~7LL;
+    for (int i = 0; i < SECTIONS; ++i) {
+      offset[i] = pos;
+      pos += (length(i) * sizeof(int) + 7) & ~7LL;
+    }
+    size = pos;
+  }
+
+  ///\return True if the header was written by a compatible writer
+  bool valid() const {
+    return memcmp(magic, "CHLEMON", 8) == 0 && version == FILE_VERSION && byte_order == ORDER_MARK;
+  }
+};
+
+#endif
@@ -19,23 +19,178 @@
 #ifndef ContractDijkstra_H
 #define ContractDijkstra_H
 
+#include <climits>
+#include <vector>
 #include <lemon/list_graph.h>
 #include "CHDijkstra.h"
+#include "WitnessPolicy.h"
 
+using std::vector;
 using lemon::ListDigraph;
 
-class ContractDijkstra: public CHDijkstra<ListDigraph> {
+///The dijkstra algorithm used for the witness searches of the contraction.
+///It can run on the ListDigraph or on a ContractionGraph.
+///
+///The searches can be limited by the number of hops and the number of settled nodes.
+///If a search gives up, the targets not settled yet need shortcuts.
+///
+///A witness search knows its targets, the out neighbours of the contracted node, with the cost of the
+///path through the contracted node as bound. A target is witnessed as soon as it is reached with a
+///distance not greater than its bound, and the search stops when every target is witnessed or the
+///next distance is greater than the bound of every target not witnessed yet.
+///\tparam GR The type of the graph
+///\tparam H The type of the heap
+template <typename GR = ListDigraph, typename H = BinHeap<int, typename GR::template NodeMap<int> > >
+class ContractDijkstra: public CHDijkstra<GR, H> {
 
-private:
+protected:
 
-  typedef CHDijkstra<ListDigraph> super;
-  typedef ListDigraph Graph;
+  typedef CHDijkstra<GR, H> super;
+  typedef GR Graph;
+  typedef typename super::Node Node;
+  typedef typename super::NodeMap NodeMap;
+  typedef typename super::OutArcIt OutArcIt;
+
+  int _hoplimit;
+  int _settledlimit;
+  int _settled;
+  NodeMap *_level;
+  ///The bound of the targets not witnessed yet, -1 for the other nodes
+  NodeMap *_bound;
+  vector<Node> _targets;
+  ///The number of targets not witnessed yet
+  int _open;
+  ///The max bound of the targets not witnessed yet
+  int _maxbound;
+
+  ///Checks whether a target is witnessed by a path of the given length.
+  void witness(Node x, int d) {
+    int b = (*_bound)[x];
+    if (b < 0 || d > b) return;
+    (*_bound)[x] = -1;
+    if (--_open > 0 && b == _maxbound) {
+      _maxbound = 0;
+      for (unsigned int i = 0; i < _targets.size(); ++i) {
+        if ((*_bound)[_targets[i]] > _maxbound) _maxbound = (*_bound)[_targets[i]];
+      }
+    }
+  }
 
 public:
 
-  ContractDijkstra(Graph& graph, ArcMap& cost):
-  super(graph, cost) {}
+  ContractDijkstra(Graph& graph, typename super::ArcMap& cost):
+  super(graph, cost) {
+    _hoplimit = INT_MAX;
+    _settledlimit = INT_MAX;
+    _settled = 0;
+    _level = new NodeMap(*this->_graph, 0);
+    _bound = new NodeMap(*this->_graph, -1);
+    _open = 0;
+    _maxbound = 0;
+  }
+
+  ~ContractDijkstra() {
+    delete _level;
+    delete _bound;
+  }
+
+  ///Sets the max number of hops.
+  void setLimit(int hops) {
+    _hoplimit = hops;
+  }
+
+  ///Sets the budgets of the searches.
+  void setLimit(const WitnessLimit& limit) {
+    _hoplimit = limit.hops;
+    _settledlimit = limit.settled;
+  }
+
+  ///\return Whether the search has settled as many nodes as allowed
+  bool exhausted() const {
+    return _settled >= _settledlimit;
+  }
+
+  ///Adds a target of the next witness search.
+  ///\param x The target
+  ///\param bound The length of the path through the contracted node
+  void addTarget(Node x, int bound) {
+    if ((*_bound)[x] < 0) {
+      _targets.push_back(x);
+      ++_open;
+    }
+    else if ((*_bound)[x] <= bound) return;
+    (*_bound)[x] = bound;
+    if (bound > _maxbound) _maxbound = bound;
+  }
+
+  ///Runs a witness search for the added targets.
+  ///\param s The source node
+  void witnessSearch(Node s) {
+    this->addSource(s);
+    witness(s, 0);
+    while (_open > 0 && this->nextNode() != INVALID && !exhausted()
+           && this->currentDist(this->nextNode()) <= _maxbound) {
+      processNextNode();
+    }
+  }
+
+  ///\param x The target
+  ///\param d The length of the path through the contracted node
+  ///\return Whether the witness search found a path to x not longer than d
+  bool witnessed(Node x, int d) const {
+    return this->_heap->state(x) != -1 && this->currentDist(x) <= d;
+  }
+
+  ///Reset every calculated value and the targets.
+  void clear() {
+    super::clear();
+    _settled = 0;
+    for (unsigned int i = 0; i < _targets.size(); ++i) {
+      (*_bound)[_targets[i]] = -1;
+    }
+    _targets.clear();
+    _open = 0;
+    _maxbound = 0;
+  }
+
+  ///Add a new source.
+  ///\param s The source node
+  ///\param d The initial distance
+  void addSource(Node s, int d = 0) {
+    super::addSource(s, d);
+    (*_level)[s] = 0;
+  }
 
+  ///Process the next node. The arcs are not relaxed if the hop limit is reached.
+  Node processNextNode() {
+    Node v = this->_heap->top();
+    int d = this->_heap->prio();
+    this->_heap->pop();
+    (*this->_distance)[v] = d;
+    ++_settled;
+    if ((*_level)[v] >= _hoplimit) return v;
+    for (OutArcIt e(*this->_graph,v); e!=INVALID; ++e) {
+      Node w = this->_graph->target(e);
+      switch(this->_heap->state(w)) {
+      case -1:
+        this->_heap->push(w, d + (*this->_cost)[e]);
+        this->touch(w);
+        (*_level)[w] = (*_level)[v] + 1;
+        if (_open > 0) witness(w, d + (*this->_cost)[e]);
+        break;
+      case 0:
+        if (d + (*this->_cost)[e] < (*this->_heap)[w]) {
+          this->_heap->decrease(w, d + (*this->_cost)[e]);
+          (*_level)[w] = (*_level)[v] + 1;
+          if (_open > 0) witness(w, d + (*this->_cost)[e]);
+        }
+        break;
+      case -2:
+        break;
+      }
+    }
+    return v;
+  }
 };
 
 #endif
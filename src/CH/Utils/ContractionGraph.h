@@ -0,0 +1,256 @@
+/* -*- mode: C++; indent-tabs-mode: nil; -*-
+ *
+ * This file is a part of LEMON, a generic C++ optimization library.
+ *
+ * Copyright (C) 2003-2013
+ * Egervary Jeno Kombinatorikus Optimalizalasi Kutatocsoport
+ * (Egervary Research Group on Combinatorial Optimization, EGRES).
+ *
+ * Permission to use, modify and distribute this software is granted
+ * provided that this copyright notice appears in all copies. For
+ * precise terms see the accompanying LICENSE file.
+ *
+ * This software is provided "AS IS" with no warranty of any kind,
+ * express or implied, and with no claim as to its suitability for any
+ * purpose.
+ *
+ */
+
+#ifndef ContractionGraph_H
+#define ContractionGraph_H
+
+#include <vector>
+#include <unordered_map>
+#include <lemon/core.h>
+#include <lemon/list_graph.h>
+
+using std::vector;
+using lemon::ListDigraph;
+using lemon::INVALID;
+
+///A digraph used as the working graph of the contraction.
+///
+///Every node stores its live in and out arcs in contiguous arrays, and the arcs of a contracted
+///node are dropped from the arrays of its neighbours, so the searches never step over dead arcs.
+///Parallel arcs are merged, only the cheapest one is kept, and the arc between two nodes can be
+///found in constant time. Every arc refers to the ListDigraph arc it represents.
+///
+///The class provides the part of the LEMON digraph interface used by CHDijkstra.
+///The nodes and the node maps are the ones of the ListDigraph.
+class ContractionGraph {
+
+public:
+
+  typedef ListDigraph::Node Node;
+
+  ///An arc record, the costs are stored inline.
+  struct Edge {
+    int source;
+    int target;
+    int cost;
+    ListDigraph::Arc arc;
+  };
+
+  ///An arc of the graph, only valid until the arrays of its end nodes change.
+  class Arc {
+    friend class ContractionGraph;
+  protected:
+    const Edge *_edge;
+  public:
+    Arc() {}
+    Arc(lemon::Invalid): _edge(NULL) {}
+    explicit Arc(const Edge* edge): _edge(edge) {}
+    bool operator==(const Arc& arc) const { return _edge == arc._edge; }
+    bool operator!=(const Arc& arc) const { return _edge != arc._edge; }
+    bool operator<(const Arc& arc) const { return _edge < arc._edge; }
+  };
+
+  ///Iterates the out arcs of a node.
+  class OutArcIt: public Arc {
+    const Edge *_end;
+  public:
+    OutArcIt(lemon::Invalid): Arc(INVALID), _end(NULL) {}
+    OutArcIt(const ContractionGraph& graph, Node v) {
+      const vector<Edge>& arcs = graph._out[graph.id(v)];
+      _edge = arcs.empty() ? NULL : &arcs[0];
+      _end = arcs.empty() ? NULL : &arcs[0] + arcs.size();
+    }
+    OutArcIt& operator++() {
+      ++_edge;
+      if (_edge == _end) _edge = NULL;
+      return *this;
+    }
+  };
+
+  ///Iterates the in arcs of a node.
+  class InArcIt: public Arc {
+    const Edge *_end;
+  public:
+    InArcIt(lemon::Invalid): Arc(INVALID), _end(NULL) {}
+    InArcIt(const ContractionGraph& graph, Node v) {
+      const vector<Edge>& arcs = graph._in[graph.id(v)];
+      _edge = arcs.empty() ? NULL : &arcs[0];
+      _end = arcs.empty() ? NULL : &arcs[0] + arcs.size();
+    }
+    InArcIt& operator++() {
+      ++_edge;
+      if (_edge == _end) _edge = NULL;
+      return *this;
+    }
+  };
+
+  ///The node maps of the ListDigraph.
+  template <typename V>
+  class NodeMap: public ListDigraph::NodeMap<V> {
+  public:
+    NodeMap(const ContractionGraph& graph):
+      ListDigraph::NodeMap<V>(*graph._graph) {}
+    NodeMap(const ContractionGraph& graph, const V& value):
+      ListDigraph::NodeMap<V>(*graph._graph, value) {}
+  };
+
+  ///Read-only arc map of the costs stored in the arc records.
+  template <typename V>
+  class ArcMap {
+  public:
+    typedef Arc Key;
+    typedef V Value;
+    ArcMap(const ContractionGraph&) {}
+    V operator[](const Arc& arc) const { return arc._edge->cost; }
+  };
+
+private:
+
+  const ListDigraph *_graph;
+  vector<vector<Edge> > _out;
+  vector<vector<Edge> > _in;
+  ///The index of the arc between two nodes in the out array of the source
+  std::unordered_map<unsigned long long, int> _index;
+  ArcMap<int> _costmap;
+
+  static unsigned long long key(int u, int w) {
+    return (static_cast<unsigned long long>(u) << 32) | static_cast<unsigned int>(w);
+  }
+
+  ///Removes the arc from u to w from the in array of w.
+  void eraseIn(int u, int w) {
+    vector<Edge>& arcs = _in[w];
+    for (unsigned int i = 0; i < arcs.size(); ++i) {
+      if (arcs[i].source == u) {
+        arcs[i] = arcs.back();
+        arcs.pop_back();
+        return;
+      }
+    }
+  }
+
+  ///Removes the arc from u to w from the out array of u.
+  void eraseOut(int u, int w) {
+    vector<Edge>& arcs = _out[u];
+    std::unordered_map<unsigned long long, int>::iterator it = _index.find(key(u, w));
+    int i = it->second;
+    _index.erase(it);
+    if (i + 1 != static_cast<int>(arcs.size())) {
+      arcs[i] = arcs.back();
+      _index[key(u, arcs[i].target)] = i;
+    }
+    arcs.pop_back();
+  }
+
+public:
+
+  ///Builds the graph from the arcs of a ListDigraph. Loops are left out.
+  ///\param graph The graph
+  ///\param cost The arc costs
+  ContractionGraph(const ListDigraph& graph, const ListDigraph::ArcMap<int>& cost):
+    _graph(&graph), _out(graph.maxNodeId() + 1), _in(graph.maxNodeId() + 1), _costmap(*this) {
+    for (ListDigraph::ArcIt e(graph); e != INVALID; ++e) {
+      Node u = graph.source(e);
+      Node w = graph.target(e);
+      if (u == w) continue;
+      if (findArc(u, w) == INVALID || cost[e] < cost[findArc(u, w)]) {
+        setArc(u, w, cost[e], e);
+      }
+    }
+  }
+
+  int id(Node v) const {
+    return _graph->id(v);
+  }
+
+  int maxNodeId() const {
+    return _graph->maxNodeId();
+  }
+
+  Node nodeFromId(int id) const {
+    return _graph->nodeFromId(id);
+  }
+
+  Node source(Arc arc) const {
+    return nodeFromId(arc._edge->source);
+  }
+
+  Node target(Arc arc) const {
+    return nodeFromId(arc._edge->target);
+  }
+
+  ///\return The ListDigraph arc represented by the arc
+  ListDigraph::Arc origArc(Arc arc) const {
+    return arc._edge->arc;
+  }
+
+  ///\return The map of the arc costs
+  ArcMap<int>& costMap() {
+    return _costmap;
+  }
+
+  ///\return The ListDigraph arc from u to w or INVALID if there is no such arc
+  ListDigraph::Arc findArc(Node u, Node w) const {
+    std::unordered_map<unsigned long long, int>::const_iterator it = _index.find(key(id(u), id(w)));
+    if (it == _index.end()) return INVALID;
+    return _out[id(u)][it->second].arc;
+  }
+
+  ///Adds an arc from u to w or changes the existing one.
+  ///\param u The source
+  ///\param w The target
+  ///\param cost The cost of the arc
+  ///\param arc The ListDigraph arc represented by the arc
+  void setArc(Node u, Node w, int cost, ListDigraph::Arc arc) {
+    Edge edge;
+    edge.source = id(u);
+    edge.target = id(w);
+    edge.cost = cost;
+    edge.arc = arc;
+    std::unordered_map<unsigned long long, int>::iterator it = _index.find(key(edge.source, edge.target));
+    if (it == _index.end()) {
+      _index[key(edge.source, edge.target)] = _out[edge.source].size();
+      _out[edge.source].push_back(edge);
+      _in[edge.target].push_back(edge);
+    } else {
+      _out[edge.source][it->second] = edge;
+      vector<Edge>& arcs = _in[edge.target];
+      for (unsigned int i = 0; i < arcs.size(); ++i) {
+        if (arcs[i].source == edge.source) arcs[i] = edge;
+      }
+    }
+  }
+
+  ///Removes a contracted node with its arcs.
+  ///\param v The node
+  void erase(Node v) {
+    int i = id(v);
+    for (unsigned int j = 0; j < _out[i].size(); ++j) {
+      int w = _out[i][j].target;
+      _index.erase(key(i, w));
+      eraseIn(i, w);
+    }
+    for (unsigned int j = 0; j < _in[i].size(); ++j) {
+      eraseOut(_in[i][j].source, i);
+    }
+    vector<Edge>().swap(_out[i]);
+    vector<Edge>().swap(_in[i]);
+  }
+};
+
+#endif
@@ -0,0 +1,126 @@
+/* -*- mode: C++; indent-tabs-mode: nil; -*-
+ *
+ * This file is a part of LEMON, a generic C++ optimization library.
+ *
+ * Copyright (C) 2003-2013
+ * Egervary Jeno Kombinatorikus Optimalizalasi Kutatocsoport
+ * (Egervary Research Group on Combinatorial Optimization, EGRES).
+ *
+ * Permission to use, modify and distribute this software is granted
+ * provided that this copyright notice appears in all copies. For
+ * precise terms see the accompanying LICENSE file.
+ *
+ * This software is provided "AS IS" with no warranty of any kind,
+ * express or implied, and with no claim as to its suitability for any
+ * purpose.
+ *
+ */
+
+#ifndef ContractionSimulator_H
+#define ContractionSimulator_H
+
+#include <vector>
+#include <lemon/list_graph.h>
+#include "EdgeDiffDijkstra.h"
+#include "Shortcut.h"
+#include "../CHData.h"
+
+using std::vector;
+using lemon::ListDigraph;
+using lemon::INVALID;
+
+///The result of a simulated contraction.
+struct Simulation {
+
+  ///The number of shortcuts which would be added
+  int shortcuts;
+  ///The number of in arcs from not contracted nodes
+  int in;
+  ///The number of out arcs to not contracted nodes
+  int out;
+  ///The number of original arcs represented by the shortcuts
+  int hops;
+
+  Simulation(): shortcuts(0), in(0), out(0), hops(0) {}
+};
+
+///Simulates the contraction of a node without changing the graph.
+///
+///The simulation only reads the graph, so more nodes can be simulated at the same time
+///if every thread uses its own dijkstra.
+class ContractionSimulator {
+
+  typedef ListDigraph Graph;
+  typedef Graph::Node Node;
+  typedef Graph::OutArcIt OutArcIt;
+  typedef Graph::InArcIt InArcIt;
+  typedef Graph::NodeMap<int> NodeMap;
+
+private:
+
+  CHData *_data;
+  const NodeMap *_state;
+
+  ///\return Whether v is already contracted
+  bool contracted(Node v) const {
+    return (*_state)[v] == -2;
+  }
+
+  ///\return The number of original arcs represented by the arc
+  int hops(Graph::Arc e) const {
+    return _data->hops == NULL ? 1 : (*_data->hops)[e];
+  }
+
+public:
+
+  ///Initializes the simulator.
+  ///\param chdata The CHData struct containing the graph and the arc costs
+  ///\param state The heap state of the nodes, contracted nodes have -2
+  ContractionSimulator(CHData& chdata, const NodeMap& state):
+    _data(&chdata), _state(&state) {}
+
+  ///Simulates the contraction of v.
+  ///\param v The node
+  ///\param dijkstra The EdgeDiffDijkstra used for the witness searches
+  ///\param shortcuts If it is given, the shortcuts are added to this vector
+  ///\return The number of shortcuts, the degrees of v and the hops of the shortcuts
+  template <typename D>
+  Simulation simulate(Node v, D& dijkstra, vector<Shortcut>* shortcuts = NULL) const {
+    const Graph& g = *_data->graph;
+    const Graph::ArcMap<int>& cost = *_data->cost;
+    Simulation s;
+    dijkstra.addContractedNode(v);
+    for (OutArcIt e(g, v); e != INVALID; ++e) {
+      if (contracted(g.target(e))) continue;
+      s.out += 1;
+    }
+    for (InArcIt e(g, v); e != INVALID; ++e) {
+      Node w = g.source(e);
+      if (contracted(w)) continue;
+      if (g.id(w) == g.id(v)) continue;
+      s.in += 1;
+      for (OutArcIt f(g, v); f != INVALID; ++f) {
+        Node x = g.target(f);
+        if (contracted(x)) continue;
+        if (g.id(x) == g.id(v)) continue;
+        dijkstra.addTarget(x, cost[e] + cost[f]);
+      }
+      dijkstra.witnessSearch(w);
+      for (OutArcIt f(g, v); f != INVALID; ++f) {
+        Node x = g.target(f);
+        if (contracted(x)) continue;
+        if (g.id(x) == g.id(v)) continue;
+        if (!dijkstra.witnessed(x, cost[e] + cost[f])) {
+          s.shortcuts += 1;
+          s.hops += hops(e) + hops(f);
+          if (shortcuts != NULL) shortcuts->push_back(Shortcut(e, f, cost[e] + cost[f]));
+        }
+      }
+      dijkstra.clear();
+    }
+    dijkstra.removeContractedNode(v);
+    return s;
+  }
+};
+
+#endif
@@ -0,0 +1,300 @@
+/* -*- mode: C++; indent-tabs-mode: nil; -*-
+ *
+ * This file is a part of LEMON, a generic C++ optimization library.
+ *
+ * Copyright (C) 2003-2013
+ * Egervary Jeno Kombinatorikus Optimalizalasi Kutatocsoport
+ * (Egervary Research Group on Combinatorial Optimization, EGRES).
+ *
+ * Permission to use, modify and distribute this software is granted
+ * provided that this copyright notice appears in all copies. For
+ * precise terms see the accompanying LICENSE file.
+ *
+ * This software is provided "AS IS" with no warranty of any kind,
+ * express or implied, and with no claim as to its suitability for any
+ * purpose.
+ *
+ */
+#ifndef DimacsReader_H
+#define DimacsReader_H
+
+#include <climits>
+#include <vector>
+#include <string>
+#ifdef _WIN32
+#include <fstream>
+#include <iterator>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include <lemon/list_graph.h>
+#include <lemon/static_graph.h>
+#include <lemon/error.h>
+#include "Parallel.h"
+
+using std::vector;
+using std::string;
+using lemon::ListDigraph;
+using lemon::StaticDigraph;
+
+///Reads a DIMACS shortest path problem (.gr) file into adjacency arrays.
+///
+///The file is mapped into memory (read into a buffer on Windows) and the "p" and "a" lines are parsed
+///without streams, optionally by more threads on chunks of the file split at line boundaries. The arcs
+///are stored by source in CSR form, with the position of every arc of the file. The graph can be built
+///into a ListDigraph with the same node and arc ids as lemon::readDimacsSp() gives, or into a
+///StaticDigraph.
+class DimacsReader {
+
+  ///The arcs read from a part of the file
+  struct Chunk {
+    vector<int> source;
+    vector<int> target;
+    vector<int> cost;
+    bool error;
+  };
+
+private:
+
+  string _filename;
+  int _nodes;
+  ///The arcs in the order of the file, freed when the CSR arrays are built
+  vector<int> _source;
+  vector<int> _target;
+  vector<int> _cost;
+  ///The position of the arcs of the file in the CSR arrays
+  vector<int> _order;
+  vector<int> _begin;
+  vector<int> _head;
+  vector<int> _arc_cost;
+
+  static bool space(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+  }
+
+  ///Reads the next integer of the line.
+  ///\param p The current position, moved after the number
+  ///\param end The end of the data
+  ///\param x The number read
+  ///\return False if there is no number before the end of the line or it doesn't fit into an int
+  static bool scan(const char*& p, const char* end, int& x) {
+    while (p < end && space(*p)) ++p;
+    bool negative = p < end && *p == '-';
+    if (negative) ++p;
+    if (p == end || *p < '0' || *p > '9') return false;
+    int value = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+      if (value > (INT_MAX - (*p - '0')) / 10) return false;
+      value = value * 10 + (*p - '0');
+      ++p;
+    }
+    x = negative ? -value : value;
+    return true;
+  }
+
+  ///\return The position after the end of the line
+  static const char* nextLine(const char* p, const char* end) {
+    while (p < end && *p != '\n') ++p;
+    return p < end ? p + 1 : end;
+  }
+
+  ///Reads the arc lines of a part of the file.
+  ///\param p The start of a line
+  ///\param end The end of the part
+  void readArcs(const char* p, const char* end, Chunk& chunk) const {
+    chunk.error = false;
+    while (p < end) {
+      if (*p == 'a') {
+        const char* q = p + 1;
+        int u, v, c;
+        if (!scan(q, end, u) || !scan(q, end, v) || !scan(q, end, c) || u < 1 || u > _nodes || v < 1 || v > _nodes) {
+          chunk.error = true;
+          return;
+        }
+        chunk.source.push_back(u - 1);
+        chunk.target.push_back(v - 1);
+        chunk.cost.push_back(c);
+      }
+      p = nextLine(p, end);
+    }
+  }
+
+  ///Parses the mapped file.
+  void read(const char* data, const char* end, bool parallel) {
+    // the problem line comes before the arcs
+    const char* p = data;
+    while (p < end && *p != 'p' && *p != 'a') p = nextLine(p, end);
+    int arcs = 0;
+    const char* q = p + 1;
+    while (q < end && space(*q)) ++q;
+    if (p == end || *p != 'p' || end - q < 2 || q[0] != 's' || q[1] != 'p' ||
+        (q += 2, !scan(q, end, _nodes)) || !scan(q, end, arcs) || _nodes < 0 || arcs < 0) {
+      throw lemon::FormatError("Missing problem line", _filename);
+    }
+    p = nextLine(p, end);
+
+    int threads = parallel ? maxThreads() : 1;
+    if (end - p < (1 << 20)) threads = 1;
+    vector<const char*> bound(threads + 1, end);
+    bound[0] = p;
+    for (int i = 1; i < threads; ++i) {
+      const char* b = p + (end - p) / threads * i;
+      bound[i] = b > bound[i - 1] ? nextLine(b - 1, end) : bound[i - 1];
+    }
+    vector<Chunk> chunks(threads);
+    for (int i = 0; i < threads; ++i) {
+      chunks[i].source.reserve(arcs / threads + 1);
+      chunks[i].target.reserve(arcs / threads + 1);
+      chunks[i].cost.reserve(arcs / threads + 1);
+    }
+#pragma omp parallel for schedule(static, 1) if (threads > 1)
+    for (int i = 0; i < threads; ++i) {
+      readArcs(bound[i], bound[i + 1], chunks[i]);
+    }
+
+    for (int i = 0; i < threads; ++i) {
+      if (chunks[i].error) throw lemon::FormatError("Invalid arc line", _filename);
+      _source.insert(_source.end(), chunks[i].source.begin(), chunks[i].source.end());
+      _target.insert(_target.end(), chunks[i].target.begin(), chunks[i].target.end());
+      _cost.insert(_cost.end(), chunks[i].cost.begin(), chunks[i].cost.end());
+      vector<int>().swap(chunks[i].source);
+      vector<int>().swap(chunks[i].target);
+      vector<int>().swap(chunks[i].cost);
+    }
+  }
+
+  ///Sorts the arcs by source, keeping the order of the file between the arcs of a node, then frees
+  ///the arcs in the order of the file.
+  void buildArrays() {
+    _begin.assign(_nodes + 1, 0);
+    for (unsigned int i = 0; i < _source.size(); ++i) {
+      ++_begin[_source[i] + 1];
+    }
+    for (int v = 0; v < _nodes; ++v) {
+      _begin[v + 1] += _begin[v];
+    }
+    vector<int> pos(_begin.begin(), _begin.end() - 1);
+    _order.resize(_source.size());
+    _head.resize(_source.size());
+    _arc_cost.resize(_source.size());
+    for (unsigned int i = 0; i < _source.size(); ++i) {
+      int a = pos[_source[i]]++;
+      _order[i] = a;
+      _head[a] = _target[i];
+      _arc_cost[a] = _cost[i];
+    }
+    vector<int>().swap(_source);
+    vector<int>().swap(_target);
+    vector<int>().swap(_cost);
+  }
+
+public:
+
+  ///Reads a file.
+  ///\param filename The name of the file
+  ///\param parallel Whether the file is parsed by more threads
+  DimacsReader(const char* filename, bool parallel = false):
+    _filename(filename), _nodes(0) {
+#ifdef _WIN32
+    std::ifstream in(filename, std::ios::binary);
+    if (!in) throw lemon::IoError("Cannot open file", filename);
+    string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (in.bad()) throw lemon::IoError("Cannot read file", filename);
+    read(data.data(), data.data() + data.size(), parallel);
+#else
+    int fd = open(filename, O_RDONLY);
+    if (fd == -1) throw lemon::IoError("Cannot open file", filename);
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+      close(fd);
+      throw lemon::IoError("Cannot read file", filename);
+    }
+    if (st.st_size == 0) {
+      close(fd);
+      throw lemon::FormatError("Missing problem line", filename);
+    }
+    void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) throw lemon::IoError("Cannot map file", filename);
+    madvise(data, st.st_size, MADV_SEQUENTIAL);
+    try {
+      read(static_cast<const char*>(data), static_cast<const char*>(data) + st.st_size, parallel);
+    } catch (...) {
+      munmap(data, st.st_size);
+      throw;
+    }
+    munmap(data, st.st_size);
+#endif
+    buildArrays();
+  }
+
+  ///\return The number of nodes
+  int nodeNum() const {
+    return _nodes;
+  }
+
+  ///\return The number of arcs
+  int arcNum() const {
+    return _head.size();
+  }
+
+  ///\return The first arc of every node in the CSR arrays and the number of arcs
+  const vector<int>& begin() const {
+    return _begin;
+  }
+
+  ///\return The target of the arcs in the CSR arrays
+  const vector<int>& head() const {
+    return _head;
+  }
+
+  ///\return The cost of the arcs in the CSR arrays
+  const vector<int>& cost() const {
+    return _arc_cost;
+  }
+
+  ///Builds the graph into an empty ListDigraph. Node i of the file gets the id i - 1, the arcs get
+  ///their ids in the order of the file.
+  ///\param g The graph
+  ///\param c The cost of the arcs
+  void build(ListDigraph& g, ListDigraph::ArcMap<int>& c) const {
+    g.reserveNode(_nodes);
+    g.reserveArc(_head.size());
+    for (int i = 0; i < _nodes; ++i) {
+      g.addNode();
+    }
+    // the source of the arcs in the CSR arrays
+    vector<int> source(_head.size());
+    for (int v = 0; v < _nodes; ++v) {
+      for (int a = _begin[v]; a < _begin[v + 1]; ++a) {
+        source[a] = v;
+      }
+    }
+    for (unsigned int i = 0; i < _order.size(); ++i) {
+      int a = _order[i];
+      c[g.addArc(g.nodeFromId(source[a]), g.nodeFromId(_head[a]))] = _arc_cost[a];
+    }
+  }
+
+  ///Builds the graph into a StaticDigraph. Node i of the file gets the id i - 1, the arcs get the
+  ///ids of the CSR arrays.
+  ///\param g The graph
+  ///\param c The cost of the arcs
+  void build(StaticDigraph& g, StaticDigraph::ArcMap<int>& c) const {
+    vector<std::pair<int, int> > arcs(_head.size());
+    for (int v = 0; v < _nodes; ++v) {
+      for (int a = _begin[v]; a < _begin[v + 1]; ++a) {
+        arcs[a] = std::make_pair(v, _head[a]);
+      }
+    }
+    g.build(_nodes, arcs.begin(), arcs.end());
+    for (int a = 0; a < static_cast<int>(_head.size()); ++a) {
+      c[g.arcFromId(a)] = _arc_cost[a];
+    }
+  }
+};
+
+#endif
@@ -20,70 +20,30 @@
 #define EdgeDiffDijkstra_H
 
 #include <lemon/list_graph.h>
-#include "CHDijkstra.h"
+#include "ContractDijkstra.h"
 
 using lemon::ListDigraph;
 
-class EdgeDiffDijkstra: public CHDijkstra<ListDigraph> {
+///The dijkstra algorithm used for the simulated contractions.
+///By default the searches are limited to 5 hops.
+///\tparam H The type of the heap
+template <typename H = BinHeap<int, ListDigraph::NodeMap<int> > >
+class EdgeDiffDijkstra: public ContractDijkstra<ListDigraph, H> {
 
-  typedef CHDijkstra<ListDigraph> super;
+  typedef ContractDijkstra<ListDigraph, H> super;
   typedef ListDigraph Graph;
-
-private:
-
-  int _hoplimit;
-  NodeMap *_level;
+  typedef typename super::Node Node;
+  typedef typename super::ArcMap ArcMap;
 
 public:
 
   EdgeDiffDijkstra(Graph& graph, ArcMap& cost):
   super(graph, cost) {
-    _hoplimit = 5;
-    _level = new NodeMap(*_graph, 0);
-  }
-
-  ~EdgeDiffDijkstra() {
-    delete _level;
+    this->_hoplimit = 5;
   }
 
   void removeContractedNode(Node v) {
-    (*_state)[v] = -1;
-  }
-
-  void setLimit(int i) {
-    _hoplimit = i;
-  }
-
-  void clearNode(Node v) {
-    super::clearNode(v);
-    (*_level)[v] = 0;
-  }
-
-  Node processNextNode() {
-    Node v = _heap->top();
-    int d = _heap->prio();
-    _heap->pop();
-    (*_distance)[v] = d;
-    if ((*_level)[v] >= _hoplimit) return v;
-    for (OutArcIt e(*_graph,v); e!=INVALID; ++e) {
-      Node w = _graph->target(e);
-      switch(_heap->state(w)) {
-      case -1:
-        _heap->push(w, d + (*_cost)[e]);
-        _reset_stack->push(w);
-        (*_level)[w] = (*_level)[v] + 1;
-        break;
-      case 0:
-        if (d + (*_cost)[e] < (*_heap)[w]) {
-          _heap->decrease(w, d + (*_cost)[e]);
-          (*_level)[w] = (*_level)[v] + 1;
-        }
-        break;
-      case -2:
-        break;
-      }
-    }
-    return v;
+    super::State::setBase(*this->_state, v, -1);
   }
 };
 
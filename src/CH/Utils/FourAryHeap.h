@@ -0,0 +1,207 @@
+/* -*- mode: C++; indent-tabs-mode: nil; -*-
+ *
+ * This file is a part of LEMON, a generic C++ optimization library.
+ *
+ * Copyright (C) 2003-2013
+ * Egervary Jeno Kombinatorikus Optimalizalasi Kutatocsoport
+ * (Egervary Research Group on Combinatorial Optimization, EGRES).
+ *
+ * Permission to use, modify and distribute this software is granted
+ * provided that this copyright notice appears in all copies. For
+ * precise terms see the accompanying LICENSE file.
+ *
+ * This software is provided "AS IS" with no warranty of any kind,
+ * express or implied, and with no claim as to its suitability for any
+ * purpose.
+ *
+ */
+#ifndef FourAryHeap_H
+#define FourAryHeap_H
+
+#include <vector>
+
+using std::vector;
+
+///A 4-ary heap storing the priorities and the items next to each other in one array.
+///
+///It has the same interface as the LEMON heaps, so it can be used as the heap of the dijkstra classes.
+///The comparisons read the priorities only from the array, the item-int map is written just when
+///an item moves. The array starts with three unused entries, so the four children of a node
+///are always in one aligned group of the array.
+///\tparam PR The type of the priorities
+///\tparam IM A read-writable item map with int values, used to store the positions of the items
+template <typename PR, typename IM>
+class FourAryHeap {
+
+public:
+
+  typedef IM ItemIntMap;
+  typedef PR Prio;
+  typedef typename ItemIntMap::Key Item;
+
+  ///The states of the items, the same as the states of the LEMON heaps.
+  enum State {
+    IN_HEAP = 0,
+    PRE_HEAP = -1,
+    POST_HEAP = -2
+  };
+
+private:
+
+  ///An entry of the heap
+  struct Entry {
+    Prio prio;
+    Item item;
+
+    Entry() {}
+    Entry(const Item& i, const Prio& p): prio(p), item(i) {}
+  };
+
+  ///The position of the root
+  static const int ROOT = 3;
+
+  vector<Entry> _data;
+  ItemIntMap &_iim;
+
+  static int parent(int i) {
+    return (i >> 2) + 2;
+  }
+
+  static int firstChild(int i) {
+    return (i - 2) << 2;
+  }
+
+  void move(const Entry& e, int i) {
+    _data[i] = e;
+    _iim.set(e.item, i);
+  }
+
+  void bubbleUp(int hole, const Entry& e) {
+    while (hole > ROOT) {
+      int par = parent(hole);
+      if (!(e.prio < _data[par].prio)) break;
+      move(_data[par], hole);
+      hole = par;
+    }
+    move(e, hole);
+  }
+
+  void bubbleDown(int hole, const Entry& e, int length) {
+    int child = firstChild(hole);
+    while (child < length) {
+      int min = child;
+      int last = child + 4 < length ? child + 4 : length;
+      for (int c = child + 1; c < last; ++c) {
+        if (_data[c].prio < _data[min].prio) min = c;
+      }
+      if (!(_data[min].prio < e.prio)) break;
+      move(_data[min], hole);
+      hole = min;
+      child = firstChild(hole);
+    }
+    move(e, hole);
+  }
+
+public:
+
+  ///\param map The item-int map, it has to be PRE_HEAP for the items to be put in the heap
+  explicit FourAryHeap(ItemIntMap& map):
+    _data(ROOT), _iim(map) {}
+
+  ///\return The number of items in the heap
+  int size() const {
+    return _data.size() - ROOT;
+  }
+
+  ///\return Whether the heap is empty
+  bool empty() const {
+    return _data.size() == ROOT;
+  }
+
+  ///Makes the heap empty. The item-int map is not changed.
+  void clear() {
+    _data.resize(ROOT);
+  }
+
+  ///Inserts an item with the given priority.
+  void push(const Item& i, const Prio& p) {
+    int n = _data.size();
+    _data.push_back(Entry(i, p));
+    bubbleUp(n, Entry(i, p));
+  }
+
+  ///\return The item with the minimum priority
+  Item top() const {
+    return _data[ROOT].item;
+  }
+
+  ///\return The minimum priority
+  Prio prio() const {
+    return _data[ROOT].prio;
+  }
+
+  ///Deletes the item with the minimum priority.
+  void pop() {
+    int n = _data.size() - 1;
+    _iim.set(_data[ROOT].item, POST_HEAP);
+    if (n > ROOT) bubbleDown(ROOT, _data[n], n);
+    _data.pop_back();
+  }
+
+  ///Deletes the given item from the heap.
+  void erase(const Item& i) {
+    int h = _iim[i];
+    int n = _data.size() - 1;
+    _iim.set(_data[h].item, POST_HEAP);
+    if (h < n) {
+      if (_data[n].prio < _data[h].prio) bubbleUp(h, _data[n]);
+      else bubbleDown(h, _data[n], n);
+    }
+    _data.pop_back();
+  }
+
+  ///\return The priority of the item, it has to be in the heap
+  Prio operator[](const Item& i) const {
+    return _data[_iim[i]].prio;
+  }
+
+  ///Inserts the item or changes its priority.
+  void set(const Item& i, const Prio& p) {
+    int idx = _iim[i];
+    if (idx < 0) push(i, p);
+    else if (p < _data[idx].prio) bubbleUp(idx, Entry(i, p));
+    else bubbleDown(idx, Entry(i, p), _data.size());
+  }
+
+  ///Decreases the priority of an item in the heap.
+  void decrease(const Item& i, const Prio& p) {
+    bubbleUp(_iim[i], Entry(i, p));
+  }
+
+  ///Increases the priority of an item in the heap.
+  void increase(const Item& i, const Prio& p) {
+    bubbleDown(_iim[i], Entry(i, p), _data.size());
+  }
+
+  ///\return The state of the item
+  State state(const Item& i) const {
+    int s = _iim[i];
+    if (s >= 0) s = 0;
+    return State(s);
+  }
+
+  ///Sets the state of an item, it is deleted from the heap if it was in the heap.
+  void state(const Item& i, State st) {
+    switch (st) {
+    case POST_HEAP:
+    case PRE_HEAP:
+      if (state(i) == IN_HEAP) erase(i);
+      _iim[i] = st;
+      break;
+    case IN_HEAP:
+      break;
+    }
+  }
+};
+
+#endif
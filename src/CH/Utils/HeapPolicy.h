@@ -0,0 +1,90 @@
+/* -*- mode: C++; indent-tabs-mode: nil; -*-
+ *
+ * This file is a part of LEMON, a generic C++ optimization library.
+ *
+ * Copyright (C) 2003-2013
+ * Egervary Jeno Kombinatorikus Optimalizalasi Kutatocsoport
+ * (Egervary Research Group on Combinatorial Optimization, EGRES).
+ *
+ * Permission to use, modify and distribute this software is granted
+ * provided that this copyright notice appears in all copies. For
+ * precise terms see the accompanying LICENSE file.
+ *
+ * This software is provided "AS IS" with no warranty of any kind,
+ * express or implied, and with no claim as to its suitability for any
+ * purpose.
+ *
+ */
+
+#ifndef HeapPolicy_H
+#define HeapPolicy_H
+
+#include <lemon/bin_heap.h>
+#include <lemon/maps.h>
+#include "FourAryHeap.h"
+#include "VersionedNodeMap.h"
+
+using lemon::BinHeap;
+using lemon::RangeMap;
+
+///The heap policies select the heap of the searches in Preprocess, in the priorities and in the
+///query classes, so a workload can use another heap without changing their code.
+///
+///A policy has a member template Heap, whose type is the heap of int priorities using the given
+///item-int map. Any LEMON heap can be used by writing such a policy.
+
+///The policy of BinHeap, used by default.
+struct BinHeapPolicy {
+  template <typename IM>
+  struct Heap {
+    typedef BinHeap<int, IM> type;
+  };
+};
+
+///The policy of FourAryHeap.
+struct FourAryHeapPolicy {
+  template <typename IM>
+  struct Heap {
+    typedef FourAryHeap<int, IM> type;
+  };
+};
+
+///The policy of a heap whose item-int map of the search states is versioned, so clearing a search
+///only starts a new round of the map instead of resetting the reached nodes.
+///\tparam HP The policy of the heap
+template <typename HP>
+struct Versioned {
+  template <typename IM>
+  struct Heap {
+    typedef typename HP::template Heap<IM>::type type;
+  };
+};
+
+///The heap of the dijkstra classes on a graph, its item-int map is an int NodeMap.
+///\tparam GR The type of the graph
+///\tparam HP The heap policy
+template <typename GR, typename HP>
+struct SearchHeap {
+  typedef typename HP::template Heap<typename GR::template NodeMap<int> >::type type;
+};
+
+template <typename GR, typename HP>
+struct SearchHeap<GR, Versioned<HP> > {
+  typedef typename HP::template Heap<VersionedNodeMap<GR> >::type type;
+};
+
+///The heap of the searches on the ints of a range, its item-int map is a RangeMap.
+///\tparam HP The heap policy
+template <typename HP>
+struct RangeHeap {
+  typedef RangeMap<int> StateMap;
+  typedef typename HP::template Heap<StateMap>::type type;
+};
+
+template <typename HP>
+struct RangeHeap<Versioned<HP> > {
+  typedef VersionedMap StateMap;
+  typedef typename HP::template Heap<StateMap>::type type;
+};
+
+#endif
@@ -0,0 +1,92 @@
+/* -*- mode: C++; indent-tabs-mode: nil; -*-
+ *
+ * This file is a part of LEMON, a generic C++ optimization library.
+ *
+ * Copyright (C) 2003-2013
+ * Egervary Jeno Kombinatorikus Optimalizalasi Kutatocsoport
+ * (Egervary Research Group on Combinatorial Optimization, EGRES).
+ *
+ * Permission to use, modify and distribute this software is granted
+ * provided that this copyright notice appears in all copies. For
+ * precise terms see the accompanying LICENSE file.
+ *
+ * This software is provided "AS IS" with no warranty of any kind,
+ * express or implied, and with no claim as to its suitability for any
+ * purpose.
+ *
+ */
+
+#ifndef IndependentSet_H
+#define IndependentSet_H
+
+#include <vector>
+#include <lemon/list_graph.h>
+#include "Parallel.h"
+
+using std::vector;
+using lemon::ListDigraph;
+using lemon::INVALID;
+
+///Compares the priority of two nodes. Ties are broken by the node ids.
+template <typename Heap>
+inline bool lessPriority(const ListDigraph& graph, const Heap& heap,
+                         ListDigraph::Node u, ListDigraph::Node v) {
+  return heap[u] < heap[v] || (heap[u] == heap[v] && graph.id(u) < graph.id(v));
+}
+
+///\return Whether every remaining node in the 2-hop neighbourhood of v has a greater priority.
+template <typename Heap>
+bool localMinimum(const ListDigraph& graph, const Heap& heap, ListDigraph::Node v) {
+  typedef ListDigraph::Node Node;
+  // the neighbours of v in both directions
+  vector<Node> neighbours;
+  for (ListDigraph::OutArcIt e(graph, v); e != INVALID; ++e) {
+    neighbours.push_back(graph.target(e));
+  }
+  for (ListDigraph::InArcIt e(graph, v); e != INVALID; ++e) {
+    neighbours.push_back(graph.source(e));
+  }
+  for (unsigned int i = 0; i < neighbours.size(); ++i) {
+    Node u = neighbours[i];
+    // contracted nodes are not part of the remaining graph
+    if (u == v || heap.state(u) != Heap::IN_HEAP) continue;
+    if (lessPriority(graph, heap, u, v)) return false;
+    for (ListDigraph::OutArcIt e(graph, u); e != INVALID; ++e) {
+      Node w = graph.target(e);
+      if (w == v || heap.state(w) != Heap::IN_HEAP) continue;
+      if (lessPriority(graph, heap, w, v)) return false;
+    }
+    for (ListDigraph::InArcIt e(graph, u); e != INVALID; ++e) {
+      Node w = graph.source(e);
+      if (w == v || heap.state(w) != Heap::IN_HEAP) continue;
+      if (lessPriority(graph, heap, w, v)) return false;
+    }
+  }
+  return true;
+}
+
+///Collects the remaining nodes whose priority is the smallest in their 2-hop neighbourhood.
+///
+///No two selected nodes are within two hops of each other, so they can be contracted
+///at the same time without touching the same arcs.
+///\param graph The graph
+///\param heap The heap containing the priorities of the remaining nodes
+///\param nodes The vector the selected nodes are added to
+template <typename Heap>
+void independentNodes(const ListDigraph& graph, const Heap& heap, vector<ListDigraph::Node>& nodes) {
+  vector<ListDigraph::Node> remaining;
+  for (ListDigraph::NodeIt v(graph); v != INVALID; ++v) {
+    if (heap.state(v) == Heap::IN_HEAP) remaining.push_back(v);
+  }
+  int k = remaining.size();
+  vector<char> selected(k, 0);
+#pragma omp parallel for schedule(dynamic, 256)
+  for (int i = 0; i < k; ++i) {
+    selected[i] = localMinimum(graph, heap, remaining[i]);
+  }
+  for (int i = 0; i < k; ++i) {
+    if (selected[i]) nodes.push_back(remaining[i]);
+  }
+}
+
+#endif
@@ -0,0 +1,75 @@
+/* -*- mode: C++; indent-tabs-mode: nil; -*-
+ *
+ * This file is a part of LEMON, a generic C++ optimization library.
+ *
+ * Copyright (C) 2003-2013
+ * Egervary Jeno Kombinatorikus Optimalizalasi Kutatocsoport
+ * (Egervary Research Group on Combinatorial Optimization, EGRES).
+ *
+ * Permission to use, modify and distribute this software is granted
+ * provided that this copyright notice appears in all copies. For
+ * precise terms see the accompanying LICENSE file.
+ *
+ * This software is provided "AS IS" with no warranty of any kind,
+ * express or implied, and with no claim as to its suitability for any
+ * purpose.
+ *
+ */
+#ifndef MinPlus_H
+#define MinPlus_H
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CH_MINPLUS_X86
+#include <immintrin.h>
+#endif
+
+///The kernels relaxing an arc for more trees at the same time: d[i] = min(d[i], s[i] + c) for i < k.
+///The sums must not overflow, so the unreached nodes have to be stored with a value far below INT_MAX.
+typedef void (*MinPlusKernel)(int* d, const int* s, int c, int k);
+
+inline void minPlusScalar(int* d, const int* s, int c, int k) {
+  for (int i = 0; i < k; ++i) {
+    int x = s[i] + c;
+    if (x < d[i]) d[i] = x;
+  }
+}
+
+#ifdef CH_MINPLUS_X86
+
+__attribute__((target("sse4.1")))
+inline void minPlusSse(int* d, const int* s, int c, int k) {
+  __m128i vc = _mm_set1_epi32(c);
+  int i = 0;
+  for (; i + 4 <= k; i += 4) {
+    __m128i x = _mm_add_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i)), vc);
+    __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(d + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i), _mm_min_epi32(x, y));
+  }
+  minPlusScalar(d + i, s + i, c, k - i);
+}
+
+__attribute__((target("avx2")))
+inline void minPlusAvx2(int* d, const int* s, int c, int k) {
+  __m256i vc = _mm256_set1_epi32(c);
+  int i = 0;
+  for (; i + 8 <= k; i += 8) {
+    __m256i x = _mm256_add_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i)), vc);
+    __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(d + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(d + i), _mm256_min_epi32(x, y));
+  }
+  minPlusScalar(d + i, s + i, c, k - i);
+}
+
+#endif
+
+///\return The fastest kernel supported by the CPU
+inline MinPlusKernel minPlusKernel() {
+#ifdef CH_MINPLUS_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) return minPlusAvx2;
+  if (__builtin_cpu_supports("sse4.1")) return minPlusSse;
+#endif
+  return minPlusScalar;
+}
+
+#endif
@@ -0,0 +1,309 @@
+/* -*- mode: C++; indent-tabs-mode: nil; -*-
+ *
+ * This file is a part of LEMON, a generic C++ optimization library.
+ *
+ * Copyright (C) 2003-2013
+ * Egervary Jeno Kombinatorikus Optimalizalasi Kutatocsoport
+ * (Egervary Research Group on Combinatorial Optimization, EGRES).
+ *
+ * Permission to use, modify and distribute this software is granted
+ * provided that this copyright notice appears in all copies. For
+ * precise terms see the accompanying LICENSE file.
+ *
+ * This software is provided "AS IS" with no warranty of any kind,
+ * express or implied, and with no claim as to its suitability for any
+ * purpose.
+ *
+ */
+#ifndef QueryGraph_H
+#define QueryGraph_H
+
+#include <climits>
+#include <vector>
+#include <algorithm>
+#include <lemon/assert.h>
+#include <lemon/list_graph.h>
+#include <lemon/static_graph.h>
+#include "../CHData.h"
+
+using std::vector;
+using std::sort;
+using lemon::ListDigraph;
+using lemon::StaticDigraph;
+using lemon::INVALID;
+
+///An arc of a QueryGraph.
+struct QueryArc {
+  ///The arc can be used by the forward search
+  static const int FORWARD = 1;
+  ///The arc can be used by the backward search
+  static const int BACKWARD = 2;
+
+  ///The higher end of the arc
+  int target;
+  int weight;
+  ///The directions of the arc
+  int flags;
+};
+
+///The forward and backward search graphs merged into one array for the queries.
+///
+///The arcs of a node go to the higher nodes. For the forward search they are the arcs of the
+///forward graph, for the backward search the arcs of the backward graph, an arc present in both
+///with the same cost is stored once with both flags. The arcs of a node are contiguous
+///{target, weight, flags} records, the forward arcs first, then the arcs of both directions, then
+///the backward arcs. So a search reads one range of one array. The node ids are the ids of the
+///search graphs.
+///
+///The paths are unpacked without the preprocessed graph: every arc stores the id of the
+///original arc, or the node bypassed by the new arc. The two halves of a new arc are the arcs of
+///the bypassed node to its ends, so the query graph is self-contained and the original graph
+///and the CHData can be deleted after it is created.
+class QueryGraph {
+
+  ///An arc of a search graph before merging
+  struct Entry {
+    int target;
+    int weight;
+    int flags;
+    ///The original arc id, or -1 - the id of the bypassed node
+    int unpack;
+
+    bool operator<(const Entry& other) const {
+      if (target != other.target) return target < other.target;
+      if (weight != other.weight) return weight < other.weight;
+      return flags < other.flags;
+    }
+  };
+
+private:
+
+  vector<int> _begin;
+  ///The first arc of both directions of every node
+  vector<int> _both;
+  ///The first backward only arc of every node
+  vector<int> _backward;
+  vector<QueryArc> _arcs;
+  ///The unpack data of the arcs in the forward and in the backward search
+  vector<int> _forward_unpack;
+  vector<int> _backward_unpack;
+  ///The node of every node id of the original graph, -1 for unused ids
+  vector<int> _node_ref;
+
+  ///Adds the arcs of a node in a search graph to the entries.
+  static void collect(vector<Entry>& entries, const CHData& chdata, const StaticDigraph& graph,
+    const StaticDigraph::ArcMap<int>& cost, const StaticDigraph::ArcMap<int>& code, int v, int flags) {
+    for (StaticDigraph::OutArcIt e(graph, graph.nodeFromId(v)); e != INVALID; ++e) {
+      Entry entry;
+      entry.target = StaticDigraph::id(graph.target(e));
+      entry.weight = cost[e];
+      entry.flags = flags;
+      entry.unpack = code[e] >= 0 ? code[e] :
+        -1 - StaticDigraph::id((*chdata.forward_nodeRef)[ListDigraph::nodeFromId((*chdata.pack)[-1 - code[e]].middle)]);
+      entries.push_back(entry);
+    }
+  }
+
+  ///Adds an arc.
+  ///\param entry The entry of the arc, its unpack data is used in the forward search
+  ///\param backward The unpack data in the backward search
+  void add(const Entry& entry, int backward, int flags) {
+    QueryArc a;
+    a.target = entry.target;
+    a.weight = entry.weight;
+    a.flags = flags;
+    _arcs.push_back(a);
+    _forward_unpack.push_back(flags & QueryArc::FORWARD ? entry.unpack : 0);
+    _backward_unpack.push_back(backward);
+  }
+
+  ///Adds the arcs of one direction.
+  void add(const vector<Entry>& entries, int flags) {
+    for (unsigned int i = 0; i < entries.size(); ++i) {
+      if (entries[i].flags != flags) continue;
+      if (flags == QueryArc::FORWARD) add(entries[i], 0, flags);
+      else add(entries[i], entries[i].unpack, flags);
+    }
+  }
+
+  ///Finds the arc of a node to a higher node.
+  ///\param v The lower node
+  ///\param u The higher node
+  ///\param weight The weight of the arc
+  ///\param direction The direction of the arc
+  ///\return The index of the arc, -1 if there is no such arc
+  int find(int v, int u, int weight, int direction) const {
+    for (int a = begin(v, direction); a < end(v, direction); ++a) {
+      if (_arcs[a].target == u && _arcs[a].weight == weight) return a;
+    }
+    return -1;
+  }
+
+  ///Recursively unpacks an arc. Any pair of arcs of the bypassed node with the ends and the weight
+  ///of the shortcut can replace it, the preprocessing ensures that there is one.
+  ///\param path The partially completed path of original arcs
+  ///\param u The source of the arc in the original graph
+  ///\param w The target of the arc in the original graph
+  ///\param weight The weight of the arc
+  ///\param unpack The unpack data of the arc
+  void unpack(vector<ListDigraph::Arc>& path, int u, int w, int weight, int unpack) const {
+    if (unpack >= 0) {
+      path.push_back(ListDigraph::arcFromId(unpack));
+      return;
+    }
+    // u -> v is a backward arc of v, v -> w is a forward arc of v
+    int v = -1 - unpack;
+    for (int a = begin(v, QueryArc::BACKWARD); a < end(v, QueryArc::BACKWARD); ++a) {
+      if (_arcs[a].target != u) continue;
+      int b = find(v, w, weight - _arcs[a].weight, QueryArc::FORWARD);
+      if (b == -1) continue;
+      this->unpack(path, u, v, _arcs[a].weight, _backward_unpack[a]);
+      this->unpack(path, v, w, _arcs[b].weight, _forward_unpack[b]);
+      return;
+    }
+    LEMON_ASSERT(false, "The bypassed arcs of a shortcut are missing");
+  }
+
+  ///Adds the arcs of the next node.
+  ///\param entries The arcs of the node in both directions
+  void addNode(vector<Entry>& entries) {
+    vector<Entry> merged;
+    sort(entries.begin(), entries.end());
+    // the forward entry comes first, merge it with a backward entry of the same cost
+    for (unsigned int i = 0; i < entries.size(); ++i) {
+      if (entries[i].flags == QueryArc::FORWARD && i + 1 < entries.size() &&
+          entries[i + 1].target == entries[i].target && entries[i + 1].weight == entries[i].weight &&
+          entries[i + 1].flags == QueryArc::BACKWARD) {
+        merged.push_back(entries[i]);
+        merged.push_back(entries[i + 1]);
+        entries[i].flags = 0;
+        entries[++i].flags = 0;
+      }
+    }
+    _begin.push_back(_arcs.size());
+    add(entries, QueryArc::FORWARD);
+    _both.push_back(_arcs.size());
+    for (unsigned int i = 0; i < merged.size(); i += 2) {
+      add(merged[i], merged[i + 1].unpack, QueryArc::FORWARD | QueryArc::BACKWARD);
+    }
+    _backward.push_back(_arcs.size());
+    add(entries, QueryArc::BACKWARD);
+  }
+
+public:
+
+  ///Merges the search graphs.
+  ///\param chdata The CHData containing a preprocessed graph
+  QueryGraph(const CHData& chdata) {
+    int n = chdata.forward_graph->nodeNum();
+    _begin.reserve(n + 1);
+    _both.reserve(n);
+    _backward.reserve(n);
+    vector<Entry> entries;
+    for (int v = 0; v < n; ++v) {
+      entries.clear();
+      collect(entries, chdata, *chdata.forward_graph, *chdata.forward_cost, *chdata.forward_backArcRef, v,
+        QueryArc::FORWARD);
+      collect(entries, chdata, *chdata.backward_graph, *chdata.backward_cost, *chdata.backward_backArcRef, v,
+        QueryArc::BACKWARD);
+      addNode(entries);
+    }
+    _begin.push_back(_arcs.size());
+
+    _node_ref.assign(chdata.graph->maxNodeId() + 1, -1);
+    for (ListDigraph::NodeIt v(*chdata.graph); v != INVALID; ++v) {
+      _node_ref[ListDigraph::id(v)] = StaticDigraph::id((*chdata.forward_nodeRef)[v]);
+    }
+  }
+
+  ///Creates the query graph from arrays, e.g. of a customized CCH.
+  ///The arcs of node v are first[v] .. first[v + 1] - 1, they go to the higher nodes head[a].
+  ///The weights and the unpack data are given for both directions, INT_MAX if the arc can't be
+  ///used in a direction. The unpack data is the original arc id or -1 - the id of the bypassed node.
+  ///\param first The first arc of the nodes and the number of arcs
+  ///\param head The higher end of the arcs
+  ///\param forward_weight The weight of the arcs from the lower end
+  ///\param backward_weight The weight of the arcs to the lower end
+  ///\param forward_unpack The unpack data of the arcs from the lower end
+  ///\param backward_unpack The unpack data of the arcs to the lower end
+  ///\param node_ref The node of every node id of the original graph, -1 for unused ids
+  QueryGraph(const vector<int>& first, const vector<int>& head, const vector<int>& forward_weight,
+    const vector<int>& backward_weight, const vector<int>& forward_unpack, const vector<int>& backward_unpack,
+    const vector<int>& node_ref):
+    _node_ref(node_ref) {
+    int n = first.size() - 1;
+    _begin.reserve(n + 1);
+    _both.reserve(n);
+    _backward.reserve(n);
+    vector<Entry> entries;
+    for (int v = 0; v < n; ++v) {
+      entries.clear();
+      for (int a = first[v]; a < first[v + 1]; ++a) {
+        Entry entry;
+        entry.target = head[a];
+        if (forward_weight[a] != INT_MAX) {
+          entry.weight = forward_weight[a];
+          entry.flags = QueryArc::FORWARD;
+          entry.unpack = forward_unpack[a];
+          entries.push_back(entry);
+        }
+        if (backward_weight[a] != INT_MAX) {
+          entry.weight = backward_weight[a];
+          entry.flags = QueryArc::BACKWARD;
+          entry.unpack = backward_unpack[a];
+          entries.push_back(entry);
+        }
+      }
+      addNode(entries);
+    }
+    _begin.push_back(_arcs.size());
+  }
+
+  ///\return The number of nodes
+  int nodeNum() const {
+    return _begin.size() - 1;
+  }
+
+  ///\return The number of arcs
+  int arcNum() const {
+    return _arcs.size();
+  }
+
+  ///\param v A node of the original graph
+  ///\return The node of the search graphs
+  StaticDigraph::Node nodeRef(ListDigraph::Node v) const {
+    return StaticDigraph::nodeFromId(_node_ref[ListDigraph::id(v)]);
+  }
+
+  ///\param v The node
+  ///\param direction QueryArc::FORWARD or QueryArc::BACKWARD
+  ///\return The index of the first arc of v in the direction
+  int begin(int v, int direction) const {
+    return direction == QueryArc::FORWARD ? _begin[v] : _both[v];
+  }
+
+  ///\param v The node
+  ///\param direction QueryArc::FORWARD or QueryArc::BACKWARD
+  ///\return The index after the last arc of v in the direction
+  int end(int v, int direction) const {
+    return direction == QueryArc::FORWARD ? _backward[v] : _begin[v + 1];
+  }
+
+  ///\param a The index of the arc
+  ///\return The arc
+  const QueryArc& arc(int a) const {
+    return _arcs[a];
+  }
+
+  ///Adds the original arcs of an arc to a path.
+  ///\param path The path
+  ///\param v The node of the arc
+  ///\param a The index of the arc
+  ///\param direction The direction of the search using the arc
+  void unpack(vector<ListDigraph::Arc>& path, int v, int a, int direction) const {
+    if (direction == QueryArc::FORWARD) unpack(path, v, _arcs[a].target, _arcs[a].weight, _forward_unpack[a]);
+    else unpack(path, _arcs[a].target, v, _arcs[a].weight, _backward_unpack[a]);
+  }
+};
+
+#endif
@@ -0,0 +1,214 @@
+/* -*- mode: C++; indent-tabs-mode: nil; -*-
+ *
+ * This file is a part of LEMON, a generic C++ optimization library.
+ *
+ * Copyright (C) 2003-2013
+ * Egervary Jeno Kombinatorikus Optimalizalasi Kutatocsoport
+ * (Egervary Research Group on Combinatorial Optimization, EGRES).
+ *
+ * Permission to use, modify and distribute this software is granted
+ * provided that this copyright notice appears in all copies. For
+ * precise terms see the accompanying LICENSE file.
+ *
+ * This software is provided "AS IS" with no warranty of any kind,
+ * express or implied, and with no claim as to its suitability for any
+ * purpose.
+ *
+ */
+#ifndef QueryGraphDijkstra_H
+#define QueryGraphDijkstra_H
+
+#include <climits>
+#include <vector>
+#include <lemon/static_graph.h>
+#include "QueryGraph.h"
+#include "HeapPolicy.h"
+
+using std::vector;
+using lemon::StaticDigraph;
+using lemon::INVALID;
+
+///The dijkstra algorithm searching in one direction of a QueryGraph.
+///
+///The nodes are given as nodes of the search graphs, so CHSearch can use it like a SearchDijkstra.
+///With stall-on-demand a settled node is not relaxed if it can be reached on a shorter path
+///through an arc of the other direction from a higher node. The nodes reached from it on a shorter
+///path than their current distance are stalled as well.
+///\tparam HP The heap policy
+template <typename HP = BinHeapPolicy>
+class QueryGraphDijkstra {
+
+  typedef StaticDigraph::Node Node;
+  typedef typename RangeHeap<HP>::StateMap StateMap;
+  typedef typename RangeHeap<HP>::type Heap;
+  typedef SearchState<StateMap> State;
+
+private:
+
+  const QueryGraph *_graph;
+  ///The flag of the arcs used by the search
+  int _direction;
+  ///The flag of the arcs used for stalling, 0 without stall-on-demand
+  int _stall_direction;
+  StateMap _state;
+  Heap _heap;
+  vector<int> _distance;
+  vector<int> _pred;
+  vector<int> _pred_node;
+  ///The length of the shorter path proving that a node is stalled
+  vector<int> _stall;
+  vector<int> _stall_queue;
+  ///The reached nodes to reset, if the states are not versioned
+  vector<int> _reset;
+
+  ///Stores a reached node for resetting it, if the states are not versioned.
+  void touch(int v) {
+    if (!State::versioned) _reset.push_back(v);
+  }
+
+  ///\param v The settled node
+  ///\param d The distance of v
+  ///\return Whether v is stalled
+  bool stalled(int v, int d) {
+    if (_stall[v] < d) return true;
+    for (int a = _graph->begin(v, _stall_direction); a < _graph->end(v, _stall_direction); ++a) {
+      const QueryArc& arc = _graph->arc(a);
+      if (_heap.state(arc.target) == -1) continue;
+      if (dist(arc.target) + arc.weight < d) {
+        stall(v, dist(arc.target) + arc.weight);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  ///Stalls a node and the reached nodes which are reached from it on a shorter path.
+  ///\param v The node
+  ///\param d The length of the shorter path to v
+  void stall(int v, int d) {
+    _stall[v] = d;
+    _stall_queue.push_back(v);
+    while (!_stall_queue.empty()) {
+      int u = _stall_queue.back();
+      _stall_queue.pop_back();
+      int end = _graph->end(u, _direction);
+      for (int a = _graph->begin(u, _direction); a < end; ++a) {
+        const QueryArc& arc = _graph->arc(a);
+        int w = arc.target;
+        int dw = _stall[u] + arc.weight;
+        if (_heap.state(w) != 0 || dw >= _heap[w] || dw >= _stall[w]) continue;
+        _stall[w] = dw;
+        _stall_queue.push_back(w);
+      }
+    }
+  }
+
+  ///\return The current distance of a reached node
+  int dist(int v) const {
+    return _heap.state(v) == -2 ? _distance[v] : _heap[v];
+  }
+
+public:
+
+  ///Initializes the algorithm.
+  ///\param graph The query graph
+  ///\param direction QueryArc::FORWARD or QueryArc::BACKWARD
+  QueryGraphDijkstra(const QueryGraph& graph, int direction):
+    _graph(&graph), _direction(direction), _stall_direction(0), _state(graph.nodeNum(), -1), _heap(_state),
+    _distance(graph.nodeNum()), _pred(graph.nodeNum()), _pred_node(graph.nodeNum()),
+    _stall(graph.nodeNum(), INT_MAX) {
+  }
+
+  ///Use stall-on-demand.
+  ///\param stall Whether stall-on-demand is used
+  void setStallOnDemand(bool stall) {
+    _stall_direction = stall ? (QueryArc::FORWARD | QueryArc::BACKWARD) & ~_direction : 0;
+  }
+
+  ///Add a new source.
+  ///\param s The source node
+  void addSource(Node s) {
+    int v = StaticDigraph::id(s);
+    if (_heap.state(v) == -1) touch(v);
+    _heap.push(v, 0);
+    _pred[v] = -1;
+    _stall[v] = INT_MAX;
+  }
+
+  ///\return The next node to be processed
+  Node nextNode() const {
+    return _heap.empty() ? INVALID : StaticDigraph::nodeFromId(_heap.top());
+  }
+
+  ///\param v The node
+  ///\return Whether v is processed.
+  bool processed(Node v) const {
+    return _heap.state(StaticDigraph::id(v)) == -2;
+  }
+
+  ///\param v The node
+  ///\return The current distance of v from the source.
+  int currentDist(Node v) const {
+    return dist(StaticDigraph::id(v));
+  }
+
+  ///\param v A reached node
+  ///\return The index of the arc used to reach v, -1 for the source
+  int predArc(Node v) const {
+    return _pred[StaticDigraph::id(v)];
+  }
+
+  ///\param v A reached node other than the source
+  ///\return The node before v on the path from the source
+  Node predNode(Node v) const {
+    return StaticDigraph::nodeFromId(_pred_node[StaticDigraph::id(v)]);
+  }
+
+  ///Process the next node. The arcs of stalled nodes are not relaxed.
+  Node processNextNode() {
+    int v = _heap.top();
+    int d = _heap.prio();
+    _heap.pop();
+    _distance[v] = d;
+    if (_stall_direction != 0 && stalled(v, d)) return StaticDigraph::nodeFromId(v);
+    int end = _graph->end(v, _direction);
+    for (int a = _graph->begin(v, _direction); a < end; ++a) {
+      const QueryArc& arc = _graph->arc(a);
+      int w = arc.target;
+      switch (_heap.state(w)) {
+      case -1:
+        _heap.push(w, d + arc.weight);
+        _pred[w] = a;
+        _pred_node[w] = v;
+        _stall[w] = INT_MAX;
+        touch(w);
+        break;
+      case 0:
+        if (d + arc.weight < _heap[w]) {
+          _heap.decrease(w, d + arc.weight);
+          _pred[w] = a;
+          _pred_node[w] = v;
+        }
+        break;
+      default:
+        break;
+      }
+    }
+    return StaticDigraph::nodeFromId(v);
+  }
+
+  ///Reset every calculated value.
+  void clear() {
+    _heap.clear();
+    if (State::versioned) {
+      State::nextRound(_state);
+      return;
+    }
+    for (unsigned int i = 0; i < _reset.size(); ++i) {
+      _state.set(_reset[i], -1);
+    }
+    _reset.clear();
+  }
+};
+
+#endif
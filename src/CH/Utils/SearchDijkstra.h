@@ -19,39 +19,113 @@
 #ifndef SearchDijkstra_H
 #define SearchDijkstra_H
 
+#include <climits>
+#include <vector>
 #include <lemon/static_graph.h>
 #include "CHDijkstra.h"
 
+using std::vector;
 using lemon::StaticDigraph;
 
 ///The dijkstra algorithm used for searching in the preprocessed CH graphs.
-class SearchDijkstra: public CHDijkstra<StaticDigraph> {
-
-  typedef CHDijkstra<StaticDigraph> super;
+///
+///With stall-on-demand a settled node is not relaxed if it can be reached on a shorter path
+///through an arc from a higher node. Such a node is not on the shortest path, and the nodes
+///reached from it on a shorter path than their current distance are stalled as well.
+///\tparam H The type of the heap
+template <typename H = BinHeap<int, StaticDigraph::NodeMap<int> > >
+class SearchDijkstra: public CHDijkstra<StaticDigraph, H> {
+
+  typedef CHDijkstra<StaticDigraph, H> super;
   typedef StaticDigraph Graph;
+  typedef typename super::Node Node;
+  typedef typename super::Arc Arc;
+  typedef typename super::ArcMap ArcMap;
+  typedef typename super::NodeMap NodeMap;
+  typedef typename super::OutArcIt OutArcIt;
   typedef Graph::NodeMap<Arc> PredMap;
 
 private:
 
   PredMap *_pred;
+  ///The graph with the arcs from the higher nodes in reverse direction, NULL without stalling
+  Graph *_stall_graph;
+  ArcMap *_stall_cost;
+  ///The length of the shorter path proving that a node is stalled
+  NodeMap *_stall;
+  vector<Node> _stall_queue;
+
+  ///\param v The settled node
+  ///\param d The distance of v
+  ///\return Whether v is stalled
+  bool stalled(Node v, int d) {
+    if ((*_stall)[v] < d) return true;
+    for (OutArcIt e(*_stall_graph, v); e != INVALID; ++e) {
+      Node u = _stall_graph->target(e);
+      if (this->_heap->state(u) == -1) continue;
+      if (this->currentDist(u) + (*_stall_cost)[e] < d) {
+        stall(v, this->currentDist(u) + (*_stall_cost)[e]);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  ///Stalls a node and the reached nodes which are reached from it on a shorter path.
+  ///\param v The node
+  ///\param d The length of the shorter path to v
+  void stall(Node v, int d) {
+    (*_stall)[v] = d;
+    _stall_queue.push_back(v);
+    while (!_stall_queue.empty()) {
+      Node u = _stall_queue.back();
+      _stall_queue.pop_back();
+      for (OutArcIt e(*this->_graph, u); e != INVALID; ++e) {
+        Node w = this->_graph->target(e);
+        int dw = (*_stall)[u] + (*this->_cost)[e];
+        if (this->_heap->state(w) != 0 || dw >= (*this->_heap)[w] || dw >= (*_stall)[w]) continue;
+        (*_stall)[w] = dw;
+        _stall_queue.push_back(w);
+      }
+    }
+  }
 
 public:
 
   SearchDijkstra(Graph& graph, ArcMap& cost):
   super(graph, cost) {
-    _pred = new PredMap(*_graph, INVALID);
+    _pred = new PredMap(*this->_graph, INVALID);
+    _stall_graph = NULL;
+    _stall_cost = NULL;
+    _stall = new NodeMap(*this->_graph, INT_MAX);
   }
 
   ~SearchDijkstra() {
     delete _pred;
+    delete _stall;
+  }
+
+  ///Turns on stall-on-demand.
+  ///\param graph The search graph of the other direction, its arcs go from a node to the
+  ///higher nodes having an arc to it. The node ids have to be the same in the two graphs.
+  ///\param cost The arc costs of the other graph
+  void setStallGraph(Graph& graph, ArcMap& cost) {
+    _stall_graph = &graph;
+    _stall_cost = &cost;
+  }
+
+  ///Turns off stall-on-demand.
+  void clearStallGraph() {
+    _stall_graph = NULL;
+    _stall_cost = NULL;
   }
 
   ///Process the next node without relaxing the arcs.
   Node processWithoutRelax() {
-    Node v = _heap->top();
-    int d = _heap->prio();
-    _heap->pop();
-    (*_distance)[v] = d;
+    Node v = this->_heap->top();
+    int d = this->_heap->prio();
+    this->_heap->pop();
+    (*this->_distance)[v] = d;
     return v;
   }
 
@@ -60,30 +134,34 @@ public:
     super::clear();
   }
 
-  ///Resets the calculated values of a node.
-  ///\param v The node
-  void clearNode(Node v) {
-    super::clearNode(v);
-    (*_pred)[v] = INVALID;
+  ///Add a new source.
+  ///\param s The source node
+  ///\param d The initial distance
+  void addSource(Node s, int d = 0) {
+    super::addSource(s, d);
+    (*_pred)[s] = INVALID;
+    (*_stall)[s] = INT_MAX;
   }
 
-  ///Precess the next node.
+  ///Precess the next node. The arcs of stalled nodes are not relaxed.
   Node processNextNode() {
-    Node v = _heap->top();
-    int d = _heap->prio();
-    _heap->pop();
-    (*_distance)[v] = d;
-    for (OutArcIt e(*_graph,v); e!=INVALID; ++e) {
-      Node w = _graph->target(e);
-      switch(_heap->state(w)) {
+    Node v = this->_heap->top();
+    int d = this->_heap->prio();
+    this->_heap->pop();
+    (*this->_distance)[v] = d;
+    if (_stall_graph != NULL && stalled(v, d)) return v;
+    for (OutArcIt e(*this->_graph,v); e!=INVALID; ++e) {
+      Node w = this->_graph->target(e);
+      switch(this->_heap->state(w)) {
       case -1:
-        _heap->push(w, d + (*_cost)[e]);
+        this->_heap->push(w, d + (*this->_cost)[e]);
         (*_pred)[w] = e;
-        _reset_stack->push(w);
+        (*_stall)[w] = INT_MAX;
+        this->touch(w);
         break;
       case 0:
-        if (d + (*_cost)[e] < (*_heap)[w]) {
-          _heap->decrease(w, d + (*_cost)[e]);
+        if (d + (*this->_cost)[e] < (*this->_heap)[w]) {
+          this->_heap->decrease(w, d + (*this->_cost)[e]);
           (*_pred)[w] = e;
         }
         break;
@@ -95,9 +173,9 @@ public:
   }
 
   ///\param v The node
-  ///\return The arc of the shortest path tree whose target is v.
+  ///\return The arc of the shortest path tree whose target is v, INVALID if v is not reached.
   Arc predArc(Node v) const {
-    return (*_pred)[v];
+    return this->_heap->state(v) == -1 ? INVALID : (*_pred)[v];
   }
 };
 
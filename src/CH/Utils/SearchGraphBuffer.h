@@ -0,0 +1,176 @@
+/* -*- mode: C++; indent-tabs-mode: nil; -*-
+ *
+ * This file is a part of LEMON, a generic C++ optimization library.
+ *
+ * Copyright (C) 2003-2013
+ * Egervary Jeno Kombinatorikus Optimalizalasi Kutatocsoport
+ * (Egervary Research Group on Combinatorial Optimization, EGRES).
+ *
+ * Permission to use, modify and distribute this software is granted
+ * provided that this copyright notice appears in all copies. For
+ * precise terms see the accompanying LICENSE file.
+ *
+ * This software is provided "AS IS" with no warranty of any kind,
+ * express or implied, and with no claim as to its suitability for any
+ * purpose.
+ *
+ */
+#ifndef SearchGraphBuffer_H
+#define SearchGraphBuffer_H
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include <vector>
+#include <lemon/static_graph.h>
+#include <lemon/radix_sort.h>
+
+using std::vector;
+using std::pair;
+using std::make_pair;
+using lemon::radixSort;
+using lemon::StaticDigraph;
+
+///Append-only storage of the arcs of a search graph, filled while the nodes are contracted.
+///
+///The arcs of a node don't change once it is contracted, so they are appended as a block when it
+///is finalized. The blocks are added in contraction order, and the search graph node ids are in
+///descending contraction order, so the blocks are put into place by reversing the buffer when the
+///graph is built. The targets are stored by their ids in the original graph, because the ids in
+///the search graph depend on the final order.
+class SearchGraphBuffer {
+
+  ///An arc of the buffer
+  struct BufferArc {
+    int head;
+    int cost;
+    int code;
+  };
+
+  ///The key of the radix sort of the arcs
+  struct HeadKey {
+    typedef int result_type;
+
+    int operator()(const BufferArc& arc) const {
+      return arc.head;
+    }
+  };
+
+  ///Iterates the (source, target) pairs of the arcs for StaticDigraph::build().
+  class ArcListIterator {
+    const vector<int> *_first;
+    const vector<BufferArc> *_arcs;
+    int _node;
+    int _arc;
+
+    void skipEmpty() {
+      while (_node + 1 < static_cast<int>(_first->size()) && (*_first)[_node + 1] <= _arc) ++_node;
+    }
+
+  public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef pair<int, int> value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const pair<int, int>* pointer;
+    typedef pair<int, int> reference;
+
+    ArcListIterator(const vector<int>& first, const vector<BufferArc>& arcs, int arc):
+      _first(&first), _arcs(&arcs), _node(0), _arc(arc) {
+      skipEmpty();
+    }
+
+    pair<int, int> operator*() const {
+      return make_pair(_node, (*_arcs)[_arc].head);
+    }
+
+    ArcListIterator& operator++() {
+      ++_arc;
+      skipEmpty();
+      return *this;
+    }
+
+    bool operator==(const ArcListIterator& other) const {
+      return _arc == other._arc;
+    }
+
+    bool operator!=(const ArcListIterator& other) const {
+      return _arc != other._arc;
+    }
+  };
+
+private:
+
+  ///The first arc of the blocks
+  vector<int> _begin;
+  vector<BufferArc> _arcs;
+
+public:
+
+  ///Starts the block of the next node in contraction order, the following arcs are its out arcs.
+  void addNode() {
+    _begin.push_back(_arcs.size());
+  }
+
+  ///Adds an out arc of the last node.
+  ///\param target The id of the target in the original graph
+  ///\param cost The cost of the arc
+  ///\param code The arc code of the arc, see CHData
+  void addArc(int target, int cost, int code) {
+    BufferArc arc;
+    arc.head = target;
+    arc.cost = cost;
+    arc.code = code;
+    _arcs.push_back(arc);
+  }
+
+  ///Builds the search graph and frees the buffer.
+  ///The buffer is reversed, which puts the blocks into the order of the search graph node ids,
+  ///then the arcs of every node are put back into their order and sorted by target in parallel.
+  ///The graph is built directly from the sorted buffer.
+  ///\param nodes The number of nodes of the search graph, every node has a block
+  ///\param ref The search graph node id of every node id of the original graph
+  ///\param graph The search graph
+  ///\param cost The cost of the arcs in the search graph
+  ///\param code The arc code of the arcs in the search graph
+  void build(int nodes, const vector<int>& ref, StaticDigraph& graph, StaticDigraph::ArcMap<int>& cost,
+    StaticDigraph::ArcMap<int>& code) {
+    int arcs = _arcs.size();
+    _begin.push_back(arcs);
+    // the first arc of every search graph node, the block of node v is the block nodes - 1 - v
+    vector<int> first(nodes + 1);
+    for (int v = 0; v <= nodes; ++v) {
+      first[v] = arcs - _begin[nodes - v];
+    }
+    vector<int>().swap(_begin);
+#pragma omp parallel for if (arcs > 100000)
+    for (int a = 0; a < arcs / 2; ++a) {
+      std::swap(_arcs[a], _arcs[arcs - 1 - a]);
+    }
+#pragma omp parallel for schedule(dynamic, 256) if (nodes > 10000)
+    for (int v = 0; v < nodes; ++v) {
+      for (int a = first[v], b = first[v + 1] - 1; a < b; ++a, --b) {
+        std::swap(_arcs[a], _arcs[b]);
+      }
+      for (int a = first[v]; a < first[v + 1]; ++a) {
+        _arcs[a].head = ref[_arcs[a].head];
+      }
+      radixSort(_arcs.begin() + first[v], _arcs.begin() + first[v + 1], HeadKey());
+    }
+    graph.build(nodes, ArcListIterator(first, _arcs, 0), ArcListIterator(first, _arcs, arcs));
+#pragma omp parallel for if (arcs > 100000)
+    for (int a = 0; a < arcs; ++a) {
+      StaticDigraph::Arc e = StaticDigraph::arcFromId(a);
+      cost.set(e, _arcs[a].cost);
+      code.set(e, _arcs[a].code);
+    }
+    clear();
+  }
+
+  ///Frees the buffer.
+  void clear() {
+    vector<int>().swap(_begin);
+    vector<BufferArc>().swap(_arcs);
+  }
+};
+
+#endif
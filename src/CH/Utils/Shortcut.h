@@ -0,0 +1,40 @@
+/* -*- mode: C++; indent-tabs-mode: nil; -*-
+ *
+ * This file is a part of LEMON, a generic C++ optimization library.
+ *
+ * Copyright (C) 2003-2013
+ * Egervary Jeno Kombinatorikus Optimalizalasi Kutatocsoport
+ * (Egervary Research Group on Combinatorial Optimization, EGRES).
+ *
+ * Permission to use, modify and distribute this software is granted
+ * provided that this copyright notice appears in all copies. For
+ * precise terms see the accompanying LICENSE file.
+ *
+ * This software is provided "AS IS" with no warranty of any kind,
+ * express or implied, and with no claim as to its suitability for any
+ * purpose.
+ *
+ */
+
+#ifndef Shortcut_H
+#define Shortcut_H
+
+#include <lemon/list_graph.h>
+
+using lemon::ListDigraph;
+
+///A shortcut bypassing a contracted node.
+struct Shortcut {
+
+  ///The arc from the source of the shortcut to the contracted node
+  ListDigraph::Arc first;
+  ///The arc from the contracted node to the target of the shortcut
+  ListDigraph::Arc second;
+  ///The cost of the shortcut
+  int cost;
+
+  Shortcut(ListDigraph::Arc f, ListDigraph::Arc s, int c):
+    first(f), second(s), cost(c) {}
+};
+
+#endif
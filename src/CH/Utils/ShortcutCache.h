@@ -0,0 +1,81 @@
+/* -*- mode: C++; indent-tabs-mode: nil; -*-
+ *
+ * This file is a part of LEMON, a generic C++ optimization library.
+ *
+ * Copyright (C) 2003-2013
+ * Egervary Jeno Kombinatorikus Optimalizalasi Kutatocsoport
+ * (Egervary Research Group on Combinatorial Optimization, EGRES).
+ *
+ * Permission to use, modify and distribute this software is granted
+ * provided that this copyright notice appears in all copies. For
+ * precise terms see the accompanying LICENSE file.
+ *
+ * This software is provided "AS IS" with no warranty of any kind,
+ * express or implied, and with no claim as to its suitability for any
+ * purpose.
+ *
+ */
+
+#ifndef ShortcutCache_H
+#define ShortcutCache_H
+
+#include <vector>
+#include <lemon/list_graph.h>
+#include "Shortcut.h"
+
+using std::vector;
+using lemon::ListDigraph;
+
+///Stores the shortcuts found by the simulated contractions, so the contraction doesn't need to repeat the witness searches.
+///
+///Every node has a version which is increased whenever the arcs around the node change.
+///The shortcuts of a node are only used if the version is the same as at the time of the simulation.
+class ShortcutCache {
+
+  typedef ListDigraph Graph;
+  typedef Graph::Node Node;
+
+private:
+
+  ///The current version of the neighbourhood
+  Graph::NodeMap<int> _version;
+  ///The version of the neighbourhood when the shortcuts were stored
+  Graph::NodeMap<int> _cached;
+  Graph::NodeMap<vector<Shortcut> > _shortcuts;
+
+public:
+
+  ShortcutCache(Graph& graph):
+    _version(graph, 0), _cached(graph, -1), _shortcuts(graph) {}
+
+  ///Marks that the arcs around the node have changed.
+  ///\param v The node
+  void touch(Node v) {
+    ++_version[v];
+  }
+
+  ///Starts storing new shortcuts for a node.
+  ///Different nodes can be recorded by different threads at the same time.
+  ///\param v The node
+  ///\return The vector the shortcuts of v should be added to
+  vector<Shortcut>& record(Node v) {
+    _cached[v] = _version[v];
+    _shortcuts[v].clear();
+    return _shortcuts[v];
+  }
+
+  ///\param v The node
+  ///\return The stored shortcuts of v or NULL if the neighbourhood of v has changed since
+  const vector<Shortcut>* find(Node v) const {
+    return _cached[v] == _version[v] ? &_shortcuts[v] : NULL;
+  }
+
+  ///Frees the stored shortcuts of a node.
+  ///\param v The node
+  void erase(Node v) {
+    _cached[v] = -1;
+    vector<Shortcut>().swap(_shortcuts[v]);
+  }
+};
+
+#endif
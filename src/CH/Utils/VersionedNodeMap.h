@@ -0,0 +1,199 @@
+/* -*- mode: C++; indent-tabs-mode: nil; -*-
+ *
+ * This file is a part of LEMON, a generic C++ optimization library.
+ *
+ * Copyright (C) 2003-2013
+ * Egervary Jeno Kombinatorikus Optimalizalasi Kutatocsoport
+ * (Egervary Research Group on Combinatorial Optimization, EGRES).
+ *
+ * Permission to use, modify and distribute this software is granted
+ * provided that this copyright notice appears in all copies. For
+ * precise terms see the accompanying LICENSE file.
+ *
+ * This software is provided "AS IS" with no warranty of any kind,
+ * express or implied, and with no claim as to its suitability for any
+ * purpose.
+ *
+ */
+#ifndef VersionedNodeMap_H
+#define VersionedNodeMap_H
+
+#include <vector>
+
+using std::vector;
+
+///Reference to a value of a versioned map, reading it doesn't write the map.
+///\tparam M The type of the map
+template <typename M>
+class VersionedReference {
+  M *_map;
+  typename M::Key _key;
+public:
+  VersionedReference(M& map, const typename M::Key& key): _map(&map), _key(key) {}
+  operator int() const {
+    return static_cast<const M&>(*_map)[_key];
+  }
+  VersionedReference& operator=(int value) {
+    _map->set(_key, value);
+    return *this;
+  }
+};
+
+///An int map on the ints of a range whose values can be reset in constant time.
+///
+///Every value carries the round it was written in. Starting a new round makes every value stale,
+///and a stale value is read as the base value of the key, which survives the rounds.
+///It can be the item-int map of the heaps of the dijkstra classes, then clearing a search
+///doesn't have to visit the reached items.
+class VersionedMap {
+
+public:
+
+  typedef int Key;
+  typedef int Value;
+
+private:
+
+  struct Entry {
+    int value;
+    int base;
+    unsigned int round;
+  };
+
+  vector<Entry> _entries;
+  unsigned int _round;
+
+public:
+
+  ///\param size The number of keys, the range is [0..size-1]
+  ///\param value The initial base value of the keys
+  VersionedMap(int size, int value = 0):
+    _entries(size), _round(1) {
+    for (unsigned int i = 0; i < _entries.size(); ++i) {
+      _entries[i].base = value;
+      _entries[i].round = 0;
+    }
+  }
+
+  ///\return The value of the key in the current round
+  int operator[](Key i) const {
+    const Entry& e = _entries[i];
+    return e.round == _round ? e.value : e.base;
+  }
+
+  ///\return A reference to the value of the key
+  VersionedReference<VersionedMap> operator[](Key i) {
+    return VersionedReference<VersionedMap>(*this, i);
+  }
+
+  ///Sets the value of the key in the current round.
+  void set(Key i, int value) {
+    Entry& e = _entries[i];
+    e.value = value;
+    e.round = _round;
+  }
+
+  ///Sets the value of the key for the current and the later rounds.
+  void setBase(Key i, int value) {
+    Entry& e = _entries[i];
+    e.base = value;
+    e.value = value;
+    e.round = _round;
+  }
+
+  ///Starts a new round, every value is reset to the base value.
+  void nextRound() {
+    if (++_round == 0) {
+      for (unsigned int i = 0; i < _entries.size(); ++i) {
+        _entries[i].round = 0;
+      }
+      _round = 1;
+    }
+  }
+};
+
+///An int node map whose values can be reset in constant time, a VersionedMap on the node ids.
+///The graph must not get new nodes while the map is used.
+///\tparam GR The type of the graph
+template <typename GR>
+class VersionedNodeMap {
+
+public:
+
+  typedef typename GR::Node Key;
+  typedef int Value;
+
+private:
+
+  const GR *_graph;
+  VersionedMap _map;
+
+public:
+
+  ///\param graph The graph
+  ///\param value The initial base value of the nodes
+  VersionedNodeMap(const GR& graph, int value = 0):
+    _graph(&graph), _map(graph.maxNodeId() + 1, value) {
+  }
+
+  ///\return The value of the node in the current round
+  int operator[](const Key& v) const {
+    return _map[_graph->id(v)];
+  }
+
+  ///\return A reference to the value of the node
+  VersionedReference<VersionedNodeMap> operator[](const Key& v) {
+    return VersionedReference<VersionedNodeMap>(*this, v);
+  }
+
+  ///Sets the value of the node in the current round.
+  void set(const Key& v, int value) {
+    _map.set(_graph->id(v), value);
+  }
+
+  ///Sets the value of the node for the current and the later rounds.
+  void setBase(const Key& v, int value) {
+    _map.setBase(_graph->id(v), value);
+  }
+
+  ///Starts a new round, every value is reset to the base value.
+  void nextRound() {
+    _map.nextRound();
+  }
+};
+
+///The handling of the search states kept in a NodeMap, they are reset node by node.
+template <typename M>
+struct SearchState {
+
+  static const bool versioned = false;
+
+  static void nextRound(M&) {}
+
+  static void setBase(M& map, const typename M::Key& v, int value) {
+    map.set(v, value);
+  }
+};
+
+///The handling of the search states kept in a versioned map, they are reset by starting a new round.
+template <typename M>
+struct VersionedSearchState {
+
+  static const bool versioned = true;
+
+  static void nextRound(M& map) {
+    map.nextRound();
+  }
+
+  static void setBase(M& map, const typename M::Key& v, int value) {
+    map.setBase(v, value);
+  }
+};
+
+template <>
+struct SearchState<VersionedMap>: public VersionedSearchState<VersionedMap> {};
+
+template <typename GR>
+struct SearchState<VersionedNodeMap<GR> >: public VersionedSearchState<VersionedNodeMap<GR> > {};
+
+#endif
@@ -0,0 +1,89 @@
+/* -*- mode: C++; indent-tabs-mode: nil; -*-
+ *
+ * This file is a part of LEMON, a generic C++ optimization library.
+ *
+ * Copyright (C) 2003-2013
+ * Egervary Jeno Kombinatorikus Optimalizalasi Kutatocsoport
+ * (Egervary Research Group on Combinatorial Optimization, EGRES).
+ *
+ * Permission to use, modify and distribute this software is granted
+ * provided that this copyright notice appears in all copies. For
+ * precise terms see the accompanying LICENSE file.
+ *
+ * This software is provided "AS IS" with no warranty of any kind,
+ * express or implied, and with no claim as to its suitability for any
+ * purpose.
+ *
+ */
+
+#ifndef WitnessPolicy_H
+#define WitnessPolicy_H
+
+#include <vector>
+#include <climits>
+
+using std::vector;
+
+///The budgets of a single witness search.
+struct WitnessLimit {
+
+  ///The max number of arcs on the paths of the search
+  int hops;
+  ///The max number of settled nodes
+  int settled;
+
+  WitnessLimit(int h = INT_MAX, int s = INT_MAX):
+    hops(h), settled(s) {}
+};
+
+///Chooses the limits of the witness searches depending on the average degree of the remaining graph.
+///
+///The stages are given with increasing degree bounds, a stage is used while the average degree
+///is not greater than its bound. The last stage is used above every bound.
+///Without stages the searches are not limited.
+class WitnessPolicy {
+
+private:
+
+  vector<double> _degrees;
+  vector<WitnessLimit> _limits;
+
+public:
+
+  ///Adds a stage.
+  ///\param degree The max average degree the stage is used for
+  ///\param limit The limits of the witness searches
+  WitnessPolicy& addStage(double degree, const WitnessLimit& limit) {
+    _degrees.push_back(degree);
+    _limits.push_back(limit);
+    return *this;
+  }
+
+  ///\return Whether there are no stages
+  bool empty() const {
+    return _limits.empty();
+  }
+
+  ///\param degree The average degree of the remaining graph
+  ///\return The limits of the witness searches
+  WitnessLimit limit(double degree) const {
+    if (_limits.empty()) return WitnessLimit();
+    for (unsigned int i = 0; i < _degrees.size(); ++i) {
+      if (degree <= _degrees[i]) return _limits[i];
+    }
+    return _limits.back();
+  }
+
+  ///Creates the usual staged policy: 1-hop searches in the sparse graph, then 2-hop, then 5-hop ones
+  ///in the dense upper levels.
+  ///\param settled The max number of settled nodes of a search
+  static WitnessPolicy staged(int settled = 1000) {
+    WitnessPolicy policy;
+    policy.addStage(3.3, WitnessLimit(1, settled));
+    policy.addStage(10, WitnessLimit(2, settled));
+    policy.addStage(INT_MAX, WitnessLimit(5, settled));
+    return policy;
+  }
+};
+
+#endif
@@ -19,33 +19,60 @@
 #ifndef CHINTERFACE_H_
 #define CHINTERFACE_H_
 
+#include <vector>
+#include <lemon/assert.h>
 #include <lemon/list_graph.h>
 #include "CH/CHData.h"
 #include "CH/Preprocess.h"
-#include "CH/CHSearch.h"
-#include "CH/PathReconstruct.h"
+#include "CH/QueryContext.h"
+#include "CH/ManyToMany.h"
+#include "CH/Phast.h"
+#include "CH/RPhast.h"
+#include "CH/CHFileWriter.h"
+#include "CH/Utils/Parallel.h"
 
 using std::ifstream;
+using std::pair;
+using std::vector;
 using lemon::ListDigraph;
 
 ///This class creates an interface for using the CH search algorithm on a graph.
-template <class Prior>
+///
+///The searches without a QueryContext argument use the context of the interface, so only one
+///thread can use them. Threads searching at the same time need their own contexts, created by
+///createQueryContext().
+///
+///The witness searches of the preprocessing use the heap policy of the priority, e.g.
+///DefaultPriority<FourAryHeapPolicy>, the searches after the preprocessing use the heap policy HP.
+///\tparam Prior The priority giving the order of the nodes
+///\tparam HP The heap policy of the searches on the preprocessed graph
+template <class Prior, typename HP = BinHeapPolicy>
 class CHInterface {
 
   typedef ListDigraph Graph;
   typedef Graph::Node Node;
   typedef Graph::ArcMap<int> Cost;
-  typedef Graph::NodeMap<StaticDigraph::Node> refMap;
 
 private:
 
   CHData _chdata;
 
-  CHSearch *_chsearch;
-  PathReconstruct *_pathrec;
+  QueryContext<HP> *_context;
+  ///The contexts of the threads of the batch searches, created by the first batch needing them
+  vector<QueryContext<HP>*> _batch_contexts;
+  ///The one-to-all search, created at its first use
+  Phast<HP> *_phast;
+  ///The merged search graph of the queries, NULL if they use the static graphs
+  QueryGraph *_query_graph;
+  ///The one-to-many search for the selected targets
+  RPhast<HP> *_rphast;
 
-  refMap *_forward_noderef;
-  refMap *_backward_noderef;
+  bool _parallel;
+  bool _contraction_graph;
+  WitnessPolicy _policy;
+  bool _stall_on_demand;
+  bool _use_query_graph;
+  bool _copy_graph;
 
 public:
 
@@ -56,29 +83,88 @@ public:
     _chdata(graph, cost) {
     _chdata.nodes = countNodes(graph);
 
-    _chsearch = NULL;
-    _pathrec = NULL;
+    _context = NULL;
+    _phast = NULL;
+    _rphast = NULL;
+    _query_graph = NULL;
 
-    _forward_noderef = NULL;
-    _backward_noderef = NULL;
+    _parallel = false;
+    _contraction_graph = false;
+    _stall_on_demand = false;
+    _use_query_graph = false;
+    _copy_graph = false;
   }
 
   ///Destroys the interface object.
   ///The original graph and the arc costs won't be deleted.
   ~CHInterface() {
-    delete _pathrec;
-    delete _chsearch;
+    delete _rphast;
+    delete _phast;
+    delete _context;
+    for (unsigned int i = 0; i < _batch_contexts.size(); ++i) {
+      delete _batch_contexts[i];
+    }
+    delete _query_graph;
   }
 
   ///Runs the preprocessing algorithm.
-  ///The original graph will be changed.
+  ///The original graph will be changed, unless setCopyGraph() is used: the shortcuts are added
+  ///to it while their ends are contracted, and the cost of an original arc may be decreased.
   void createCH() {
+    if (_copy_graph && !_chdata.local_graph) _chdata.copyGraph();
     Preprocess<Prior> preproc(_chdata);
+    preproc.setParallel(_parallel);
+    preproc.setContractionGraph(_contraction_graph);
+    preproc.setWitnessPolicy(_policy);
     preproc.run();
-    _chsearch = new CHSearch(_chdata);
-    _pathrec = new PathReconstruct(_chdata, *_chsearch);
-    _forward_noderef = _chdata.forward_nodeRef;
-    _backward_noderef = _chdata.backward_nodeRef;
+    if (_use_query_graph) _query_graph = new QueryGraph(_chdata);
+    _context = createQueryContext();
+  }
+
+  ///Run the preprocessing on an internal copy of the graph and the arc costs. The shortcuts are
+  ///added to the copy, the original graph and costs are only read while createCH() copies them.
+  ///After that they can be used by other threads or deleted, the nodes and arcs of the searches
+  ///keep their ids.
+  ///The copy is a second full graph with its costs, so the memory of the graph is doubled before
+  ///the shortcuts are added.
+  ///\param copy Whether the graph is copied
+  void setCopyGraph(bool copy) {
+    _copy_graph = copy;
+  }
+
+  ///Contract independent node sets in parallel during the preprocessing.
+  ///\param parallel Whether the parallel contraction is used
+  void setParallel(bool parallel) {
+    _parallel = parallel;
+  }
+
+  ///Use a ContractionGraph for the witness searches of the preprocessing.
+  ///\param use Whether the contraction graph is used
+  void setContractionGraph(bool use) {
+    _contraction_graph = use;
+  }
+
+  ///Sets the policy limiting the witness searches of the preprocessing.
+  ///\param policy The policy, e.g. WitnessPolicy::staged()
+  void setWitnessPolicy(const WitnessPolicy& policy) {
+    _policy = policy;
+  }
+
+  ///Run the point to point searches on a QueryGraph merging the forward and backward search
+  ///graphs, it has to be set before the preprocessing.
+  ///\param use Whether the query graph is used
+  void setQueryGraph(bool use) {
+    _use_query_graph = use;
+  }
+
+  ///Use stall-on-demand in the searches.
+  ///\param stall Whether stall-on-demand is used
+  void setStallOnDemand(bool stall) {
+    _stall_on_demand = stall;
+    if (_context != NULL) _context->setStallOnDemand(stall);
+    for (unsigned int i = 0; i < _batch_contexts.size(); ++i) {
+      _batch_contexts[i]->setStallOnDemand(stall);
+    }
   }
 
   void addOrder(vector<int>& order) {
@@ -90,32 +176,165 @@ public:
     return _chdata.getOrder();
   }
 
+  ///Writes the preprocessed graph into a binary file, it can be queried with MappedCHSearch
+  ///without preprocessing again.
+  ///\param filename The name of the file
+  void writeCH(const char* filename) const {
+    CHFileWriter(_chdata).write(filename);
+  }
+
+  ///Creates a self-contained query graph of the preprocessed graph. Paths can be unpacked
+  ///from it alone, so QueryContext instances created from it can be used after the interface,
+  ///the original graph and the arc costs are deleted. The caller has to delete it.
+  ///\return The query graph
+  QueryGraph* createQueryGraph() const {
+    return new QueryGraph(_chdata);
+  }
+
+  ///Creates a new search state for a thread, it can be used after the preprocessing.
+  ///The caller has to delete it.
+  ///\return The new context
+  QueryContext<HP>* createQueryContext() const {
+    QueryContext<HP> *context = new QueryContext<HP>(_chdata, _query_graph);
+    context->setStallOnDemand(_stall_on_demand);
+    return context;
+  }
+
   ///Runs the search from Node s to Node t.
   ///\param s The source node
   ///\param t The target node
   void runSearch(Node s, Node t) const {
-    _chsearch->run((*_forward_noderef)[s], (*_backward_noderef)[t]);
+    _context->run(s, t);
+  }
+
+  ///Runs the search from Node s to Node t with the given context.
+  ///\param context The search state of the calling thread
+  ///\param s The source node
+  ///\param t The target node
+  void runSearch(QueryContext<HP>& context, Node s, Node t) const {
+    context.run(s, t);
+  }
+
+  ///Runs a batch of searches on all threads. The queries are handed out to the threads dynamically,
+  ///every thread uses its own context of the interface, so only one batch can run at a time.
+  ///The number of threads is the maximum at the time of the call, the missing contexts are created
+  ///here and kept for the later batches.
+  ///\param queries The source and target pairs
+  ///\param count The number of queries
+  ///\param dist The distances are written here, it has to have count elements
+  ///\param paths If it is given, the paths are written here, it has to have count elements
+  void runSearches(const pair<Node, Node>* queries, int count, int* dist,
+                   vector<ListDigraph::Arc>* paths = NULL) {
+    int threads = maxThreads();
+    while (static_cast<int>(_batch_contexts.size()) < threads) {
+      _batch_contexts.push_back(createQueryContext());
+    }
+#pragma omp parallel for schedule(dynamic, 64) num_threads(threads)
+    for (int i = 0; i < count; ++i) {
+      QueryContext<HP>& context = *_batch_contexts[threadNum()];
+      context.run(queries[i].first, queries[i].second);
+      dist[i] = context.dist();
+      if (paths != NULL) paths[i] = context.getPath();
+    }
+  }
+
+  ///Calculates the distances from every source to every target.
+  ///\param sources The sources
+  ///\param targets The targets
+  ///\param dist The table, the distance from sources[i] to targets[j] is written to
+  ///dist[i * targets.size() + j], -1 if the target can't be reached
+  void runManyToMany(const vector<Node>& sources, const vector<Node>& targets, int* dist) const {
+    ManyToMany<HP> manytomany(_chdata);
+    manytomany.run(sources, targets, dist);
+  }
+
+  ///Calculates the distances from a source to every node.
+  ///The search state is kept by the interface, so only one thread can use it at a time.
+  ///\param s The source
+  ///\param dist The distances are written here, indexed by the node ids, -1 for the unreachable nodes
+  ///\param parallel Whether the sweep of the nodes runs on all threads
+  void runOneToAll(Node s, vector<int>& dist, bool parallel = false) {
+    if (_phast == NULL) _phast = new Phast<HP>(_chdata);
+    if (parallel) _phast->runParallel(s);
+    else _phast->run(s);
+    dist.assign(_chdata.graph->maxNodeId() + 1, -1);
+    for (Graph::NodeIt v(*_chdata.graph); v != INVALID; ++v) {
+      dist[_chdata.graph->id(v)] = _phast->dist(v);
+    }
+  }
+
+  ///Calculates the distances from more sources to every node, 16 sources are handled in one sweep.
+  ///The search state is kept by the interface, so only one thread can use it at a time.
+  ///\param sources The sources
+  ///\param dist The distances are written here, the distance of v from sources[i] is
+  ///dist[i * (maxNodeId() + 1) + id(v)], -1 for the unreachable nodes
+  ///\param parallel Whether the sweeps of the nodes run on all threads
+  void runOneToAll(const vector<Node>& sources, vector<int>& dist, bool parallel = false) {
+    if (_phast == NULL) _phast = new Phast<HP>(_chdata);
+    long n = _chdata.graph->maxNodeId() + 1;
+    dist.assign(n * sources.size(), -1);
+    for (unsigned int first = 0; first < sources.size(); first += 16) {
+      unsigned int last = first + 16 < sources.size() ? first + 16 : sources.size();
+      _phast->run(vector<Node>(sources.begin() + first, sources.begin() + last), parallel);
+      for (Graph::NodeIt v(*_chdata.graph); v != INVALID; ++v) {
+        for (unsigned int i = first; i < last; ++i) {
+          dist[i * n + _chdata.graph->id(v)] = _phast->dist(i - first, v);
+        }
+      }
+    }
+  }
+
+  ///Selects the targets of runOneToMany(). The nodes which can lead to them are collected
+  ///once, so the later queries only sweep these nodes.
+  ///\param targets The targets
+  void selectTargets(const vector<Node>& targets) {
+    if (_rphast == NULL) _rphast = new RPhast<HP>(_chdata);
+    _rphast->selectTargets(targets);
+  }
+
+  ///Calculates the distances from a source to the selected targets.
+  ///selectTargets() has to be called before it.
+  ///\param s The source
+  ///\param dist The distance of the i-th target is written to dist[i], -1 if it can't be reached
+  void runOneToMany(Node s, int* dist) const {
+    LEMON_ASSERT(_rphast != NULL, "No targets are selected");
+    _rphast->run(s);
+    for (int i = 0; i < _rphast->targetNum(); ++i) {
+      dist[i] = _rphast->dist(i);
+    }
   }
 
   ///Runs the search from a new source node using the previous search results.
   ///\param s The new source node
   void runSearch_newSource(Node s) const {
-    _chsearch->run_newSource((*_forward_noderef)[s]);
+    _context->run_newSource(s);
   }
 
   ///\return The distance between the previous search's source and target
   int dist() const {
-    return _chsearch->dist();
+    return _context->dist();
+  }
+
+  ///\param context The context of the search
+  ///\return The distance between the source and target of the previous search of the context
+  int dist(const QueryContext<HP>& context) const {
+    return context.dist();
   }
 
   ///\return The path between the previous search's source and target
   vector<ListDigraph::Arc> getPath() const {
-    return _pathrec->getPath();
+    return _context->getPath();
+  }
+
+  ///\param context The context of the search
+  ///\return The path between the source and target of the previous search of the context
+  vector<ListDigraph::Arc> getPath(const QueryContext<HP>& context) const {
+    return context.getPath();
   }
 
   ///Clears the previous results.
   void clear() const {
-    _chsearch->clear();
+    _context->clear();
   }
 };
 
@@ -1,18 +1,261 @@
 #include <iostream>
+#include <algorithm>
 #include <lemon/random.h>
 #include <lemon/list_graph.h>
 #include <lemon/static_graph.h>
 #include <lemon/core.h>
 #include<lemon/time_measure.h>
 #include <lemon/dimacs.h>
+#include <lemon/dijkstra.h>
 #include "../CHInterface.h"
+#include "../CH/Utils/DimacsReader.h"
 #include "../CH/Utils/SearchDijkstra.h"
 #include "../CH/DefaultPriority.h"
 #include "../CH/ExpPriority.h"
+#include "../CH/CCH.h"
+#include "../CH/QueryContext.h"
+#ifndef _WIN32
+#include <cstdio>
+#include "../CH/MappedCHSearch.h"
+#endif
 
 using namespace std;
 using namespace lemon;
 
+///The graph of the checks and the results of lemon::Dijkstra on it.
+struct Reference {
+  ListDigraph g;
+  ListDigraph::ArcMap<int> c;
+  vector<int> source;
+  vector<int> target;
+  ///The distances of the queries, -1 for the unreachable targets
+  vector<int> dist;
+  ///The distances from the first sources to every node, indexed by the node ids
+  vector<vector<int> > all;
+
+  ///Reads the graph and runs the queries with lemon::Dijkstra.
+  Reference(string filename, const vector<int>& source, const vector<int>& target):
+    c(g), source(source), target(target) {
+    DimacsReader(filename.c_str(), true).build(g, c);
+    Dijkstra<ListDigraph> dijkstra(g, c);
+    for (unsigned int i = 0; i < source.size(); ++i) {
+      ListDigraph::Node t = g.nodeFromId(target[i]);
+      dijkstra.init();
+      dijkstra.addSource(g.nodeFromId(source[i]));
+      dijkstra.start(t);
+      dist.push_back(dijkstra.reached(t) ? dijkstra.dist(t) : -1);
+    }
+    all.resize(source.size() < 10 ? source.size() : 10);
+    for (unsigned int i = 0; i < all.size(); ++i) {
+      dijkstra.run(g.nodeFromId(source[i]));
+      all[i].assign(g.maxNodeId() + 1, -1);
+      for (ListDigraph::NodeIt v(g); v != INVALID; ++v) {
+        if (dijkstra.reached(v)) all[i][g.id(v)] = dijkstra.dist(v);
+      }
+    }
+  }
+
+  ///\return Whether a distance or the length of its path differs from the result of the i-th query
+  bool wrong(int i, int distance, const vector<ListDigraph::Arc>& path) const {
+    int length = 0;
+    for (unsigned int j = 0; j < path.size(); ++j) {
+      length += c[path[j]];
+    }
+    return distance != dist[i] || (dist[i] != -1 && length != dist[i]);
+  }
+};
+
+///Runs the point to point searches of a CH.
+///\return The number of queries with a wrong distance or a path of wrong length
+template <typename CH>
+int wrongDistances(CH& ch, const Reference& ref) {
+  int wrong = 0;
+  for (unsigned int i = 0; i < ref.source.size(); ++i) {
+    ch.runSearch(ListDigraph::nodeFromId(ref.source[i]), ListDigraph::nodeFromId(ref.target[i]));
+    if (ref.wrong(i, ch.dist(), ch.getPath())) ++wrong;
+  }
+  return wrong;
+}
+
+///Calculates the distance table of the first sources and targets with a CH.
+///\return The number of wrong distances
+template <typename CH>
+int wrongManyToMany(CH& ch, const Reference& ref) {
+  int k = ref.all.size();
+  vector<ListDigraph::Node> sources;
+  vector<ListDigraph::Node> targets;
+  for (int i = 0; i < k; ++i) {
+    sources.push_back(ListDigraph::nodeFromId(ref.source[i]));
+    targets.push_back(ListDigraph::nodeFromId(ref.target[i]));
+  }
+  vector<int> dist(k * k);
+  ch.runManyToMany(sources, targets, &dist[0]);
+  int wrong = 0;
+  for (int i = 0; i < k; ++i) {
+    for (int j = 0; j < k; ++j) {
+      if (dist[i * k + j] != ref.all[i][ref.target[j]]) ++wrong;
+    }
+  }
+  return wrong;
+}
+
+///Calculates the distances from the first sources to every node with a CH, the sweeps of every
+///second source run on all threads. Then the trees of all these sources are calculated at once.
+///\return The number of wrong trees
+template <typename CH>
+int wrongOneToAll(CH& ch, const Reference& ref) {
+  int wrong = 0;
+  vector<int> dist;
+  for (unsigned int i = 0; i < ref.all.size(); ++i) {
+    ch.runOneToAll(ListDigraph::nodeFromId(ref.source[i]), dist, i % 2 == 1);
+    if (dist != ref.all[i]) ++wrong;
+  }
+  vector<ListDigraph::Node> sources;
+  for (unsigned int i = 0; i < ref.all.size(); ++i) {
+    sources.push_back(ListDigraph::nodeFromId(ref.source[i]));
+  }
+  ch.runOneToAll(sources, dist);
+  int n = ref.g.maxNodeId() + 1;
+  for (unsigned int i = 0; i < ref.all.size(); ++i) {
+    if (!std::equal(ref.all[i].begin(), ref.all[i].end(), dist.begin() + i * n)) ++wrong;
+  }
+  return wrong;
+}
+
+///Calculates the distances from the first sources to the first targets with the one-to-many
+///search of a CH.
+///\return The number of wrong distances
+template <typename CH>
+int wrongOneToMany(CH& ch, const Reference& ref) {
+  int k = ref.all.size();
+  vector<ListDigraph::Node> targets;
+  for (int i = 0; i < k; ++i) {
+    targets.push_back(ListDigraph::nodeFromId(ref.target[i]));
+  }
+  ch.selectTargets(targets);
+  vector<int> dist(k);
+  int wrong = 0;
+  for (int i = 0; i < k; ++i) {
+    ch.runOneToMany(ListDigraph::nodeFromId(ref.source[i]), &dist[0]);
+    for (int j = 0; j < k; ++j) {
+      if (dist[j] != ref.all[i][ref.target[j]]) ++wrong;
+    }
+  }
+  return wrong;
+}
+
+#ifndef _WIN32
+///Writes the preprocessed graph of a CH into a file and runs the point to point searches on the
+///mapped file.
+///\return The number of queries with a wrong distance or a path of wrong length
+template <typename CH>
+int wrongFile(CH& ch, const Reference& ref) {
+  ch.writeCH("default_check.ch");
+  int wrong = 0;
+  {
+    MappedCH mapped("default_check.ch");
+    MappedCHSearch search(mapped);
+    for (unsigned int i = 0; i < ref.source.size(); ++i) {
+      search.run(ref.source[i], ref.target[i]);
+      vector<int> ids = search.getPath();
+      vector<ListDigraph::Arc> path;
+      for (unsigned int j = 0; j < ids.size(); ++j) {
+        path.push_back(ListDigraph::arcFromId(ids[j]));
+      }
+      if (ref.wrong(i, search.dist(), path)) ++wrong;
+    }
+    // ids which are not nodes can't be reached
+    search.run(-1, ref.source[0]);
+    if (search.dist() != -1) ++wrong;
+    search.run(ref.source[0], mapped.maxNodeId() + 1);
+    if (search.dist() != -1) ++wrong;
+  }
+  std::remove("default_check.ch");
+  return wrong;
+}
+#endif
+
+///Preprocesses the graph with a CH and compares its results with the reference.
+///The point to point searches run without and with stall-on-demand.
+///\param name The name of the checked feature
+///\param ch The CH, its options are set
+template <typename CH>
+void check(const char* name, CH& ch, const Reference& ref) {
+  cout << "checking " << name << "\n";
+  ch.createCH();
+  int wrong = wrongDistances(ch, ref);
+  ch.setStallOnDemand(true);
+  wrong += wrongDistances(ch, ref);
+  wrong += wrongManyToMany(ch, ref);
+  wrong += wrongOneToAll(ch, ref);
+  wrong += wrongOneToMany(ch, ref);
+#ifndef _WIN32
+  wrong += wrongFile(ch, ref);
+#endif
+  if (wrong != 0) {
+    cout << "Wrong distance: " << wrong << "\n";
+  }
+}
+
+///Checks a CH with its default options, it preprocesses a copy of the graph of the reference.
+template <typename CH>
+void check(const char* name, Reference& ref) {
+  CH ch(ref.g, ref.c);
+  ch.setCopyGraph(true);
+  check(name, ch, ref);
+}
+
+///Checks a CH with an option set, it preprocesses a copy of the graph of the reference.
+///\param option The setter of the option
+///\param value The value of the option
+template <typename CH, typename T, typename V>
+void check(const char* name, void (CH::*option)(T), const V& value, Reference& ref) {
+  CH ch(ref.g, ref.c);
+  ch.setCopyGraph(true);
+  (ch.*option)(value);
+  check(name, ch, ref);
+}
+
+///Customizes a CCH of the graph with its minimum degree order, serial and parallel, and compares
+///the point to point searches on its query graph with the reference.
+void checkCCH(const Reference& ref) {
+  cout << "checking customizable ch\n";
+  CCH cch(ref.g, CCH::minimumDegreeOrder(ref.g));
+  int wrong = 0;
+  for (int parallel = 0; parallel < 2; ++parallel) {
+    cch.customize(ref.c, parallel == 1);
+    QueryGraph* query_graph = cch.createQueryGraph();
+    QueryContext<> query(*query_graph);
+    for (unsigned int i = 0; i < ref.source.size(); ++i) {
+      query.run(ListDigraph::nodeFromId(ref.source[i]), ListDigraph::nodeFromId(ref.target[i]));
+      if (ref.wrong(i, query.dist(), query.getPath())) ++wrong;
+    }
+    delete query_graph;
+  }
+  if (wrong != 0) {
+    cout << "Wrong distance: " << wrong << "\n";
+  }
+}
+
+///Checks the optional features against lemon::Dijkstra.
+void Default_checks(string filename, const vector<int>& source, const vector<int>& target) {
+  typedef CHInterface<DefaultPriority<> > DefaultCH;
+  typedef CHInterface<DefaultPriority<FourAryHeapPolicy>, FourAryHeapPolicy> FourAryCH;
+  typedef CHInterface<DefaultPriority<Versioned<BinHeapPolicy> >, Versioned<BinHeapPolicy> > VersionedCH;
+
+  cout << "running lemon dijkstra\n";
+  Reference ref(filename, source, target);
+
+  check("parallel contraction", &DefaultCH::setParallel, true, ref);
+  check("contraction graph", &DefaultCH::setContractionGraph, true, ref);
+  check("staged witness limits", &DefaultCH::setWitnessPolicy, WitnessPolicy::staged(), ref);
+  check("query graph", &DefaultCH::setQueryGraph, true, ref);
+  checkCCH(ref);
+  check<FourAryCH>("four-ary heaps", ref);
+  check<VersionedCH>("versioned states", ref);
+  check("versioned query graph", &VersionedCH::setQueryGraph, true, ref);
+}
+
 void Default_test(string filename, int tests = 1000) {
   cout << "DEFAULT TEST\n";
 
@@ -22,9 +265,7 @@ void Default_test(string filename, int tests = 1000) {
   ListDigraph::ArcMap<int> *c = new ListDigraph::ArcMap<int>(*g);
 
   cout << "reading graph\n";
-  ifstream f(filename.c_str());
-  ListDigraph::Node v;
-  readDimacsSp(f, *g, *c, v);
+  DimacsReader(filename.c_str(), true).build(*g, *c);
   int n = countNodes(*g);
   cout << "nodes: " << n << " arcs: " << countArcs(*g) << "\n";
 
@@ -36,11 +277,11 @@ void Default_test(string filename, int tests = 1000) {
       cg.nodeRef(noderef);
       cg.arcMap(*c, sc);
       cg.run();
-  SearchDijkstra dijkstra(sg, sc);
+  SearchDijkstra<> dijkstra(sg, sc);
 
   cout << "creating ch\n";
   t.restart();
-  CHInterface<DefaultPriority> ch(*g, *c);
+  CHInterface<DefaultPriority<> > ch(*g, *c);
   ch.createCH();
   cout << t << "\n";
   cout << "nodes: " << n << " arcs: " << countArcs(*g) << "\n";
@@ -90,10 +331,26 @@ void Default_test(string filename, int tests = 1000) {
   }
   cout << t << "\n";
 
+  cout << "running ch batch\n";
+  t.restart();
+  vector<pair<ListDigraph::Node, ListDigraph::Node> > queries;
+  for (int i = 0; i < tests; ++i) {
+    queries.push_back(make_pair((*g).nodeFromId(source[i]), (*g).nodeFromId(target[i])));
+  }
+  vector<int> batchdist(tests);
+  vector<vector<ListDigraph::Arc> > batchpaths(tests);
+  ch.runSearches(&queries[0], tests, &batchdist[0], &batchpaths[0]);
+  cout << t << "\n";
+
   cout << "checking results\n";
   int wrong = 0;
   for (int i = 0; i < tests; ++i) {
-    if (ddist[i] != chdist[i]) {
+    int dist = 0;
+    for (unsigned int j = 0; j < batchpaths[i].size(); ++j) {
+      dist += (*c)[batchpaths[i][j]];
+    }
+    // the paths of unreachable targets are empty, but their distances are -1
+    if (ddist[i] != chdist[i] || ddist[i] != dist || (batchdist[i] != -1 && batchdist[i] != ddist[i])) {
       ++wrong;
     }
   }
@@ -104,6 +361,8 @@ void Default_test(string filename, int tests = 1000) {
   delete c;
   delete g;
 
+  Default_checks(filename, source, target);
+
   cout << "finished\n";
 
 }
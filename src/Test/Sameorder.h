@@ -6,6 +6,7 @@
 #include<lemon/time_measure.h>
 #include <lemon/dimacs.h>
 #include "../CHInterface.h"
+#include "../CH/Utils/DimacsReader.h"
 #include "../CH/Utils/SearchDijkstra.h"
 #include "../CH/DefaultPriority.h"
 #include "../CH/PredetPriority.h"
@@ -22,15 +23,13 @@ void Sameorder_test(string filename1, string filename2, int tests = 1000) {
   ListDigraph::ArcMap<int> *c = new ListDigraph::ArcMap<int>(*g);
 
   cout << "reading graph\n";
-  ifstream f(filename1.c_str());
-  ListDigraph::Node v;
-  readDimacsSp(f, *g, *c, v);
+  DimacsReader(filename1.c_str(), true).build(*g, *c);
   int n = countNodes(*g);
   cout << "nodes: " << n << " arcs: " << countArcs(*g) << "\n";
 
   cout << "creating ch\n";
   t.restart();
-  CHInterface<DefaultPriority> *ch = new CHInterface<DefaultPriority>(*g, *c);
+  CHInterface<DefaultPriority<> > *ch = new CHInterface<DefaultPriority<> >(*g, *c);
   ch->createCH();
   cout << t << "\n";
   cout << "nodes: " << n << " arcs: " << countArcs(*g) << "\n";
@@ -44,8 +43,7 @@ void Sameorder_test(string filename1, string filename2, int tests = 1000) {
   cout << "reading second graph\n";
   g = new ListDigraph;
   c = new ListDigraph::ArcMap<int>(*g);
-  ifstream f2(filename2.c_str());
-  readDimacsSp(f2, *g, *c, v);
+  DimacsReader(filename2.c_str(), true).build(*g, *c);
 
   cout << "creating dijkstra\n";
   StaticDigraph sg;
@@ -55,7 +53,7 @@ void Sameorder_test(string filename1, string filename2, int tests = 1000) {
       cg.nodeRef(noderef);
       cg.arcMap(*c, sc);
       cg.run();
-  SearchDijkstra dijkstra(sg, sc);
+  SearchDijkstra<> dijkstra(sg, sc);
 
   cout << "creating new ch\n";
   CHInterface<PredetPriority> *pch = new CHInterface<PredetPriority>(*g, *c);
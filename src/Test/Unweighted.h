@@ -6,6 +6,7 @@
 #include<lemon/time_measure.h>
 #include <lemon/dimacs.h>
 #include "../CHInterface.h"
+#include "../CH/Utils/DimacsReader.h"
 #include "../CH/Utils/bfs.h"
 #include "../CH/DefaultPriority.h"
 
@@ -21,9 +22,7 @@ void Unweighted_test(string filename, int tests = 1000) {
   ListDigraph::ArcMap<int> *c = new ListDigraph::ArcMap<int>(*g);
 
   cout << "reading graph\n";
-  ifstream f(filename.c_str());
-  ListDigraph::Node v;
-  readDimacsSp(f, *g, *c, v);
+  DimacsReader(filename.c_str(), true).build(*g, *c);
   int n = countNodes(*g);
   cout << "nodes: " << n << " arcs: " << countArcs(*g) << "\n";
 
@@ -43,7 +42,7 @@ void Unweighted_test(string filename, int tests = 1000) {
 
   cout << "creating ch\n";
   t.restart();
-  CHInterface<DefaultPriority> ch(*g, *c);
+  CHInterface<DefaultPriority<> > ch(*g, *c);
   ch.createCH();
   cout << t << "\n";
   cout << "nodes: " << n << " arcs: " << countArcs(*g) << "\n";